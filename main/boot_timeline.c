@@ -0,0 +1,150 @@
+/*
+ * SPDX-FileCopyrightText: 2022-2024 Espressif Systems (Shanghai) CO LTD
+ *
+ * SPDX-License-Identifier: CC0-1.0
+ */
+
+#include <string.h>
+
+#include "boot_timeline.h"
+
+static boot_run_t *current_run(boot_timeline_t *timeline) {
+  if (timeline->boots == 0) {
+    return NULL;
+  }
+  return &timeline->runs[(timeline->boots - 1) % BOOT_TIMELINE_HISTORY];
+}
+
+static boot_run_t *start_run(boot_timeline_t *timeline, int64_t now_us) {
+  // overwrites the oldest boot once the history is full
+  boot_run_t *run = &timeline->runs[timeline->boots % BOOT_TIMELINE_HISTORY];
+  timeline->boots++;
+  run->number = timeline->boots;
+  run->start_us = now_us;
+  run->next = 0;
+  for (size_t i = 0; i < BOOT_TIMELINE_MAX_MILESTONES; i++) {
+    run->at_us[i] = -1;
+  }
+  return run;
+}
+
+static void reach(boot_timeline_t *timeline, boot_run_t *run, size_t milestone, int64_t now_us) {
+  run->at_us[milestone] = now_us - run->start_us;
+  run->next = milestone + 1;
+  timeline->generation++;
+}
+
+void boot_timeline_init(boot_timeline_t *timeline, const boot_milestone_t *milestones, size_t count) {
+  memset(timeline, 0, sizeof(*timeline));
+  timeline->milestones = milestones;
+  timeline->count = count < BOOT_TIMELINE_MAX_MILESTONES ? count : BOOT_TIMELINE_MAX_MILESTONES;
+}
+
+bool boot_timeline_feed_line(boot_timeline_t *timeline, const char *line, int64_t now_us) {
+  boot_run_t *run = current_run(timeline);
+  size_t next = run != NULL ? run->next : 0;
+
+  // milestones may be skipped, e.g. debug lines disabled on the target
+  for (size_t i = next; i < timeline->count; i++) {
+    if (strstr(line, timeline->milestones[i].pattern) != NULL) {
+      if (run == NULL) {
+        run = start_run(timeline, now_us);
+      }
+      reach(timeline, run, i, now_us);
+      return true;
+    }
+  }
+
+  // a banner the current boot is already past means the target was reset
+  for (size_t i = 0; i < next; i++) {
+    if (timeline->milestones[i].starts_boot && strstr(line, timeline->milestones[i].pattern) != NULL) {
+      run = start_run(timeline, now_us);
+      reach(timeline, run, i, now_us);
+      return true;
+    }
+  }
+  return false;
+}
+
+const boot_run_t *boot_timeline_run(const boot_timeline_t *timeline, uint32_t age) {
+  if (age >= timeline->boots || age >= BOOT_TIMELINE_HISTORY) {
+    return NULL;
+  }
+  return &timeline->runs[(timeline->boots - 1 - age) % BOOT_TIMELINE_HISTORY];
+}
+
+int64_t boot_timeline_phase_us(const boot_timeline_t *timeline, const boot_run_t *run, size_t milestone) {
+  if (milestone >= timeline->count || run->at_us[milestone] < 0) {
+    return -1;
+  }
+  for (size_t i = milestone + 1; i < timeline->count; i++) {
+    if (run->at_us[i] >= 0) {
+      return run->at_us[i] - run->at_us[milestone];
+    }
+  }
+  return -1;
+}
+
+int64_t boot_timeline_total_us(const boot_timeline_t *timeline, const boot_run_t *run) {
+  int64_t first = -1;
+  int64_t last = -1;
+  for (size_t i = 0; i < timeline->count; i++) {
+    if (run->at_us[i] >= 0) {
+      if (first < 0) {
+        first = run->at_us[i];
+      }
+      last = run->at_us[i];
+    }
+  }
+  return first < 0 ? 0 : last - first;
+}
+
+static void write_json_string(FILE *f, const char *s) {
+  fputc('"', f);
+  for (; *s != '\0'; s++) {
+    if (*s == '"' || *s == '\\') {
+      fputc('\\', f);
+    }
+    if ((unsigned char)*s >= 0x20) {
+      fputc(*s, f);
+    }
+  }
+  fputc('"', f);
+}
+
+size_t boot_timeline_write_trace(const boot_timeline_t *timeline, FILE *f) {
+  size_t events = 0;
+
+  fprintf(f, "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[");
+  // oldest first, so the trace viewer lists boots in order
+  for (uint32_t age = BOOT_TIMELINE_HISTORY; age-- > 0;) {
+    const boot_run_t *run = boot_timeline_run(timeline, age);
+    if (run == NULL) {
+      continue;
+    }
+
+    fprintf(f, "%s\n{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":%lu,\"args\":{\"name\":\"Boot %lu\"}}", events ? "," : "", (unsigned long)run->number,
+            (unsigned long)run->number);
+    events++;
+
+    for (size_t i = 0; i < timeline->count; i++) {
+      if (run->at_us[i] < 0) {
+        continue;
+      }
+      int64_t ts = run->start_us + run->at_us[i];
+      int64_t dur = boot_timeline_phase_us(timeline, run, i);
+      fprintf(f, ",\n{\"name\":");
+      write_json_string(f, timeline->milestones[i].name);
+      if (dur < 0) {
+        // the last milestone reached has no end yet, mark it as an instant
+        // on its boot's row
+        fprintf(f, ",\"ph\":\"i\",\"s\":\"t\",\"ts\":%lld,\"pid\":1,\"tid\":%lu}", (long long)ts, (unsigned long)run->number);
+      } else {
+        fprintf(f, ",\"ph\":\"X\",\"ts\":%lld,\"dur\":%lld,\"pid\":1,\"tid\":%lu}", (long long)ts, (long long)dur, (unsigned long)run->number);
+      }
+      events++;
+    }
+  }
+  fprintf(f, "\n]}\n");
+  return events;
+}
@@ -0,0 +1,112 @@
+/*
+ * SPDX-FileCopyrightText: 2022-2024 Espressif Systems (Shanghai) CO LTD
+ *
+ * SPDX-License-Identifier: CC0-1.0
+ */
+
+#ifndef BOOT_TIMELINE_H
+#define BOOT_TIMELINE_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdio.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define BOOT_TIMELINE_MAX_MILESTONES (12)
+// Boots kept for display, comparison and export
+#define BOOT_TIMELINE_HISTORY (8)
+
+/**
+ * @brief A line that marks a point in the target's boot
+ *
+ * Milestones are listed in boot order. A boot moves forward only: a line is
+ * matched against the milestones after the last one reached. A milestone
+ * with starts_boot set that matches anywhere else begins a new boot, so list
+ * every banner that can be the first line after a reset that way.
+ */
+typedef struct {
+  const char *name;    /*!< Phase name in the chart and the trace */
+  const char *pattern; /*!< Substring searched for in every text line */
+  bool starts_boot;
+} boot_milestone_t;
+
+/**
+ * @brief Timeline of one boot
+ */
+typedef struct {
+  uint32_t number;                               /*!< Boots seen since start, from 1 */
+  int64_t start_us;                              /*!< Arrival of the first milestone */
+  int64_t at_us[BOOT_TIMELINE_MAX_MILESTONES];   /*!< Arrival relative to start_us, -1 if not reached */
+  uint8_t next;                                  /*!< First milestone that can still be reached */
+} boot_run_t;
+
+/**
+ * @brief Boot history built from milestone matches
+ *
+ * Timestamps are the arrival times of the matching lines, the target's own
+ * timestamps are not needed. Does not depend on FreeRTOS so it can be built
+ * on the host.
+ */
+typedef struct {
+  const boot_milestone_t *milestones;
+  size_t count;
+  boot_run_t runs[BOOT_TIMELINE_HISTORY]; /*!< Ring, the newest boot at (boots - 1) % BOOT_TIMELINE_HISTORY */
+  uint32_t boots;                         /*!< Boots seen since start */
+  uint32_t generation;                    /*!< Incremented on every change */
+} boot_timeline_t;
+
+/**
+ * @brief Reset the history and set the milestones, at most BOOT_TIMELINE_MAX_MILESTONES
+ */
+void boot_timeline_init(boot_timeline_t *timeline, const boot_milestone_t *milestones, size_t count);
+
+/**
+ * @brief Match one framed, NUL terminated line
+ *
+ * @return true if the line was a milestone
+ */
+bool boot_timeline_feed_line(boot_timeline_t *timeline, const char *line, int64_t now_us);
+
+/**
+ * @brief Get a boot from the history
+ *
+ * @param age 0 for the newest boot, 1 for the one before, ...
+ * @return NULL if there is no such boot
+ */
+const boot_run_t *boot_timeline_run(const boot_timeline_t *timeline, uint32_t age);
+
+/**
+ * @brief Duration of the phase starting at a milestone
+ *
+ * A phase lasts until the next milestone reached in the same boot.
+ *
+ * @return Duration in microseconds, -1 if the milestone was not reached or
+ *         is the last one reached so far
+ */
+int64_t boot_timeline_phase_us(const boot_timeline_t *timeline, const boot_run_t *run, size_t milestone);
+
+/**
+ * @brief Time from the first to the last milestone reached
+ */
+int64_t boot_timeline_total_us(const boot_timeline_t *timeline, const boot_run_t *run);
+
+/**
+ * @brief Write the history as Chrome trace event JSON
+ *
+ * Every boot is a thread, every phase a complete ("X") event and the last
+ * milestone reached an instant ("i") event. Timestamps are in the same
+ * esp_timer clock as raw captures. Opens in chrome://tracing and Perfetto.
+ *
+ * @return Number of events written
+ */
+size_t boot_timeline_write_trace(const boot_timeline_t *timeline, FILE *f);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // BOOT_TIMELINE_H
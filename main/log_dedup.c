@@ -0,0 +1,99 @@
+/*
+ * SPDX-FileCopyrightText: 2022-2024 Espressif Systems (Shanghai) CO LTD
+ *
+ * SPDX-License-Identifier: CC0-1.0
+ */
+
+#include <string.h>
+
+#include "log_dedup.h"
+
+static uint32_t hash_line(const char *data, size_t len) {
+  // FNV-1a
+  uint32_t hash = 2166136261u;
+  for (size_t i = 0; i < len; i++) {
+    hash ^= (uint8_t)data[i];
+    hash *= 16777619u;
+  }
+  return hash;
+}
+
+static void seat(log_dedup_entry_t *entry, uint32_t hash, uint32_t len, uint32_t seq, int64_t now_us) {
+  entry->hash = hash;
+  entry->len = len;
+  entry->seq = seq;
+  entry->count = 1;
+  entry->reported = 1;
+  entry->first_us = now_us;
+  entry->last_us = now_us;
+  entry->reported_us = now_us;
+}
+
+void log_dedup_init(log_dedup_t *dedup) { memset(dedup, 0, sizeof(*dedup)); }
+
+log_dedup_entry_t *log_dedup_check(log_dedup_t *dedup, const char *data, size_t len, uint32_t seq, int64_t now_us, log_dedup_entry_t *evicted) {
+  uint32_t hash = hash_line(data, len);
+
+  for (uint32_t i = 0; i < dedup->used; i++) {
+    log_dedup_entry_t *entry = &dedup->entries[i];
+    if (entry->hash != hash || entry->len != len || memcmp(dedup->lines[i], data, len) != 0) {
+      continue;
+    }
+    if (seq - entry->seq < MAX_LOG_ROWS) {
+      entry->count++;
+      entry->last_us = now_us;
+      return entry;
+    }
+    // the row scrolled out of the view while the line kept recurring, start
+    // counting again in a new row so it stays visible
+    if (evicted != NULL) {
+      *evicted = *entry;
+    }
+    seat(entry, hash, len, seq, now_us);
+    return NULL;
+  }
+
+  log_dedup_entry_t *slot;
+  if (dedup->used < LOG_DEDUP_WINDOW) {
+    slot = &dedup->entries[dedup->used++];
+    if (evicted != NULL) {
+      memset(evicted, 0, sizeof(*evicted));
+    }
+  } else {
+    // the least recently seen line leaves the window
+    slot = &dedup->entries[0];
+    for (uint32_t i = 1; i < LOG_DEDUP_WINDOW; i++) {
+      if (dedup->entries[i].last_us < slot->last_us) {
+        slot = &dedup->entries[i];
+      }
+    }
+    if (evicted != NULL) {
+      *evicted = *slot;
+    }
+  }
+
+  memcpy(dedup->lines[slot - dedup->entries], data, len);
+  seat(slot, hash, len, seq, now_us);
+  return NULL;
+}
+
+void log_dedup_forget(log_dedup_t *dedup, uint32_t seq) {
+  for (uint32_t i = 0; i < dedup->used; i++) {
+    log_dedup_entry_t *entry = &dedup->entries[i];
+    if (entry->seq == seq) {
+      // no line is this long, so the entry never matches again
+      entry->len = UINT32_MAX;
+      return;
+    }
+  }
+}
+
+log_dedup_entry_t *log_dedup_next_unreported(log_dedup_t *dedup, int64_t now_us, int64_t min_age_us, uint32_t *cursor) {
+  while (*cursor < dedup->used) {
+    log_dedup_entry_t *entry = &dedup->entries[(*cursor)++];
+    if (entry->count != entry->reported && now_us - entry->reported_us >= min_age_us) {
+      return entry;
+    }
+  }
+  return NULL;
+}
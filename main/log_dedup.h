@@ -0,0 +1,84 @@
+/*
+ * SPDX-FileCopyrightText: 2022-2024 Espressif Systems (Shanghai) CO LTD
+ *
+ * SPDX-License-Identifier: CC0-1.0
+ */
+
+#ifndef LOG_DEDUP_H
+#define LOG_DEDUP_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#include "messaging.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define LOG_DEDUP_WINDOW (8)
+
+/**
+ * @brief A recently seen distinct line
+ */
+typedef struct {
+  uint32_t hash;
+  uint32_t len;
+  uint32_t seq;      /*!< Row the line was first shown in */
+  uint32_t count;    /*!< Total occurrences, including the first one */
+  uint32_t reported; /*!< Count last sent to the UI */
+  int64_t first_us;
+  int64_t last_us;
+  int64_t reported_us;
+} log_dedup_entry_t;
+
+/**
+ * @brief Repeated line detector
+ *
+ * Keeps the LOG_DEDUP_WINDOW most recently seen distinct lines. A line that
+ * matches one of them is counted against the existing row instead of
+ * producing a new one. The hash only preselects, a repeat is confirmed by
+ * comparing the text, so a hash collision never merges two different lines.
+ * A line whose row has left the view (MAX_LOG_ROWS) gets a new row instead.
+ * Does not depend on FreeRTOS so it can be built on the host.
+ */
+typedef struct {
+  log_dedup_entry_t entries[LOG_DEDUP_WINDOW];
+  char lines[LOG_DEDUP_WINDOW][MAX_MESSAGE_LEN]; /*!< Text of entries[i] */
+  uint32_t used;
+} log_dedup_t;
+
+void log_dedup_init(log_dedup_t *dedup);
+
+/**
+ * @brief Check a line against the window
+ *
+ * @param len At most MAX_MESSAGE_LEN
+ * @param seq Row id assigned to the line if it is new
+ * @return Entry the line was counted against, or NULL if the line is new and
+ *         was added to the window under seq. The entry evicted to make room,
+ *         or the previous state of an entry moved to a new row, is copied to
+ *         evicted when evicted is not NULL.
+ */
+log_dedup_entry_t *log_dedup_check(log_dedup_t *dedup, const char *data, size_t len, uint32_t seq, int64_t now_us, log_dedup_entry_t *evicted);
+
+/**
+ * @brief Drop the entry of a row whose text was overwritten
+ */
+void log_dedup_forget(log_dedup_t *dedup, uint32_t seq);
+
+/**
+ * @brief Iterate over entries with a count not yet sent to the UI
+ *
+ * @param min_age_us Only return entries reported at least this long ago
+ * @return Entry or NULL when none is left. The caller marks the entry as
+ *         reported.
+ */
+log_dedup_entry_t *log_dedup_next_unreported(log_dedup_t *dedup, int64_t now_us, int64_t min_age_us, uint32_t *cursor);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // LOG_DEDUP_H
@@ -0,0 +1,152 @@
+/*
+ * SPDX-FileCopyrightText: 2022-2024 Espressif Systems (Shanghai) CO LTD
+ *
+ * SPDX-License-Identifier: CC0-1.0
+ */
+
+#include <string.h>
+
+#include "log_framer.h"
+
+static void emit(log_framer_t *framer, uint8_t kind) {
+  message_t *out = &framer->out;
+
+  out->kind = kind;
+  out->data[out->len] = '\0';
+  if (framer->sink != NULL) {
+    framer->sink(out, framer->sink_ctx);
+  }
+  out->len = 0;
+  framer->erased = false;
+}
+
+// Emits the pending text into the current row, returns true if a record was
+// produced.
+static bool emit_row(log_framer_t *framer) {
+  if (framer->row_open) {
+    if (framer->out.len == 0 && !framer->erased) {
+      // cursor moved but nothing was overwritten
+      return false;
+    }
+    emit(framer, MESSAGE_KIND_REPLACE);
+    return true;
+  }
+  if (framer->out.len == 0 && !framer->erased) {
+    return false;
+  }
+  emit(framer, MESSAGE_KIND_APPEND);
+  return true;
+}
+
+// Handles one byte of an escape sequence, returns false once the byte is not
+// part of one.
+static bool handle_escape(log_framer_t *framer, uint8_t in) {
+  switch (framer->esc) {
+  case LOG_FRAMER_ESC_NONE:
+    if (in == 0x1b) {
+      framer->esc = LOG_FRAMER_ESC_STARTED;
+      return true;
+    }
+    return false;
+
+  case LOG_FRAMER_ESC_STARTED:
+    if (in == '[') {
+      framer->esc = LOG_FRAMER_ESC_CSI;
+      framer->csi_param = 0;
+      framer->csi_first_done = false;
+    } else if (in >= 0x20 && in <= 0x2f) {
+      // intermediate byte, e.g. the '(' of a charset selection ESC ( B
+    } else {
+      // final byte, nothing to interpret
+      framer->esc = LOG_FRAMER_ESC_NONE;
+    }
+    return true;
+
+  case LOG_FRAMER_ESC_CSI:
+    if (in >= '0' && in <= '9') {
+      // only the first parameter matters, saturated so large values cannot
+      // wrap to a different meaning
+      if (!framer->csi_first_done) {
+        uint16_t param = framer->csi_param * 10 + (in - '0');
+        framer->csi_param = param > UINT8_MAX ? UINT8_MAX : param;
+      }
+      return true;
+    }
+    if (in == ';') {
+      framer->csi_first_done = true;
+      return true;
+    }
+    if (in < 0x40 || in > 0x7e) {
+      // separators and intermediate bytes
+      return true;
+    }
+    framer->esc = LOG_FRAMER_ESC_NONE;
+    if (in == 'K' && framer->csi_param != 0) {
+      // erase to start or whole line, erase to end is a no-op at the end of
+      // the buffer. Only an already emitted row needs to be blanked.
+      framer->out.len = 0;
+      framer->erased = framer->row_open;
+    }
+    return true;
+  }
+
+  return false;
+}
+
+void log_framer_init(log_framer_t *framer, log_framer_sink_t sink, void *ctx) {
+  memset(framer, 0, sizeof(*framer));
+  framer->sink = sink;
+  framer->sink_ctx = ctx;
+}
+
+size_t log_framer_feed(log_framer_t *framer, const uint8_t *data, size_t len) {
+  message_t *out = &framer->out;
+  size_t lines = 0;
+
+  for (size_t i = 0; i < len; i++) {
+    uint8_t byte = data[i];
+
+    if (framer->cr_pending) {
+      framer->cr_pending = false;
+      if (byte == 0x0a) {
+        // CRLF, handled as a plain new line below
+      } else {
+        // bare CR, the following text overwrites the row
+        bool emitted = emit_row(framer);
+        lines += emitted;
+        framer->row_open = framer->row_open || emitted;
+      }
+    }
+
+    if (handle_escape(framer, byte)) {
+      continue;
+    }
+
+    if (byte == 0x0d) {
+      framer->cr_pending = true;
+      continue;
+    }
+
+    if (byte == 0x0a) {
+      if (framer->row_open) {
+        lines += emit_row(framer);
+        framer->row_open = false;
+      } else {
+        emit(framer, MESSAGE_KIND_APPEND);
+        lines++;
+      }
+      continue;
+    }
+
+    out->data[out->len] = byte;
+    out->len++;
+
+    if (out->len == MAX_MESSAGE_LEN - 1) {
+      // the remainder of an overlong line continues in a new row
+      lines += emit_row(framer);
+      framer->row_open = false;
+    }
+  }
+
+  return lines;
+}
@@ -0,0 +1,71 @@
+/*
+ * SPDX-FileCopyrightText: 2022-2024 Espressif Systems (Shanghai) CO LTD
+ *
+ * SPDX-License-Identifier: CC0-1.0
+ */
+
+#ifndef LOG_FRAMER_H
+#define LOG_FRAMER_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#include "messaging.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @brief Callback invoked for every framed line
+ *
+ * The message is owned by the framer and only valid for the duration of the
+ * call. The sink may fill in the fields the framer leaves unset.
+ */
+typedef void (*log_framer_sink_t)(message_t *msg, void *ctx);
+
+typedef enum {
+  LOG_FRAMER_ESC_NONE,
+  LOG_FRAMER_ESC_STARTED, /*!< ESC received */
+  LOG_FRAMER_ESC_CSI,     /*!< ESC [ received, collecting parameters */
+} log_framer_esc_t;
+
+/**
+ * @brief Byte stream to line framer state
+ *
+ * Strips ANSI escape sequences and splits the stream on LF or CRLF. Adapter
+ * status bytes must already be removed, see vcp_rx.h. A bare CR and the
+ * erase-line sequence (CSI K) keep the current row open, so the next text is
+ * emitted as MESSAGE_KIND_REPLACE instead of a new row. Does not depend on
+ * FreeRTOS so it can be built on the host.
+ */
+typedef struct {
+  log_framer_esc_t esc;
+  uint8_t csi_param;   /*!< First CSI parameter */
+  bool csi_first_done; /*!< ';' seen, further parameters are ignored */
+  bool cr_pending;     /*!< CR received, not yet known whether LF follows */
+  bool row_open;       /*!< Last emitted row may still be overwritten */
+  bool erased;         /*!< Row contents were erased since the last emit */
+  message_t out;
+  log_framer_sink_t sink;
+  void *sink_ctx;
+} log_framer_t;
+
+/**
+ * @brief Reset the framer and attach the line sink
+ */
+void log_framer_init(log_framer_t *framer, log_framer_sink_t sink, void *ctx);
+
+/**
+ * @brief Push raw bytes through the framer
+ *
+ * @return Number of lines handed to the sink
+ */
+size_t log_framer_feed(log_framer_t *framer, const uint8_t *data, size_t len);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // LOG_FRAMER_H
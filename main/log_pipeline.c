@@ -0,0 +1,274 @@
+/*
+ * SPDX-FileCopyrightText: 2022-2024 Espressif Systems (Shanghai) CO LTD
+ *
+ * SPDX-License-Identifier: CC0-1.0
+ */
+
+#include <stddef.h>
+#include <stdio.h>
+#include <string.h>
+
+#include "esp_err.h"
+#include "esp_heap_caps.h"
+#include "esp_timer.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/queue.h"
+#include "freertos/semphr.h"
+#include "freertos/task.h"
+
+#include "boot_timeline.h"
+#include "log_dedup.h"
+#include "log_framer.h"
+#include "log_pipeline.h"
+#include "log_stats.h"
+#include "messaging.h"
+#include "zlog_decoder.h"
+#include "zlog_dict.h"
+
+// Repeat counters are sent to the UI at most this often per row
+#define LOG_PIPELINE_REPEAT_REPORT_US (100 * 1000)
+
+static QueueHandle_t message_queue = NULL;
+static TaskHandle_t consumer = NULL;
+static SemaphoreHandle_t pipeline_mutex = NULL;
+static esp_timer_handle_t flush_timer = NULL;
+static log_framer_t framer;
+static zlog_decoder_t zlog_decoder;
+static log_dedup_t dedup;
+static log_stats_t *tag_stats = NULL;
+static boot_timeline_t boot_timeline;
+static log_pipeline_stats_t stats;
+static bool echo_enabled = true;
+static uint32_t next_seq = 0;
+// Seq of the row the framer writes into, and whether the framer's last line
+// was folded into an older row instead
+static uint32_t current_seq = 0;
+static bool current_collapsed = false;
+// Set when a message was queued since the consumer was last woken
+static bool notify_pending = false;
+
+static void post(const message_t *msg) {
+  if (xQueueSendToBack(message_queue, msg, 0) != pdTRUE) {
+    stats.dropped++;
+    return;
+  }
+  notify_pending = true;
+  // sampling the fill level from outside would miss short bursts
+  UBaseType_t depth = uxQueueMessagesWaiting(message_queue);
+  if (depth > stats.queue_peak) {
+    stats.queue_peak = depth;
+  }
+}
+
+// At most one wakeup per fed chunk rather than per line, the consumer
+// drains the queue in a batch anyway. Chunks that only extend a partial
+// line or count a suppressed repeat queue nothing and wake nobody.
+static void notify_if_queued(void) {
+  if (notify_pending && consumer != NULL) {
+    xTaskNotifyGive(consumer);
+  }
+  notify_pending = false;
+}
+
+// Suppressed repeats are reported by a one-shot timer so an idle link does
+// not keep waking the CPU
+static void arm_flush(void) {
+  if (!esp_timer_is_active(flush_timer)) {
+    esp_timer_start_once(flush_timer, LOG_PIPELINE_REPEAT_REPORT_US);
+  }
+}
+
+static void post_repeat(log_dedup_entry_t *entry) {
+  static message_t repeat_msg;
+
+  repeat_msg.kind = MESSAGE_KIND_REPEAT;
+  repeat_msg.format = MESSAGE_FORMAT_TEXT;
+  repeat_msg.seq = entry->seq;
+  repeat_msg.repeat = entry->count;
+  repeat_msg.first_us = entry->first_us;
+  repeat_msg.last_us = entry->last_us;
+  repeat_msg.data[0] = '\0';
+  repeat_msg.len = 0;
+  post(&repeat_msg);
+
+  entry->reported = entry->count;
+  entry->reported_us = entry->last_us;
+}
+
+static void flush_repeats(int64_t now, int64_t min_age_us) {
+  uint32_t cursor = 0;
+  log_dedup_entry_t *entry;
+  while ((entry = log_dedup_next_unreported(&dedup, now, min_age_us, &cursor)) != NULL) {
+    post_repeat(entry);
+  }
+}
+
+// Collapses repeats and posts the message. The first key_offset bytes of the
+// data are not compared when looking for repeats.
+static void publish(message_t *msg, int64_t now, size_t key_offset) {
+  msg->repeat = 1;
+  msg->first_us = now;
+  msg->last_us = now;
+
+  if (msg->kind == MESSAGE_KIND_REPLACE && !current_collapsed) {
+    // the row text changes, it can no longer absorb repeats
+    log_dedup_forget(&dedup, current_seq);
+    msg->seq = current_seq;
+    post(msg);
+    return;
+  }
+
+  if (msg->kind == MESSAGE_KIND_APPEND) {
+    log_dedup_entry_t evicted;
+    log_dedup_entry_t *entry = log_dedup_check(&dedup, msg->data + key_offset, msg->len - key_offset, next_seq, now, &evicted);
+    if (entry != NULL) {
+      current_collapsed = true;
+      if (now - entry->reported_us >= LOG_PIPELINE_REPEAT_REPORT_US) {
+        post_repeat(entry);
+      } else {
+        arm_flush();
+      }
+      return;
+    }
+    if (evicted.count != evicted.reported) {
+      post_repeat(&evicted);
+    }
+  }
+
+  // a new row, or an in-place update of a line that was collapsed into an
+  // older row and therefore needs a row of its own
+  stats.rows++;
+  msg->kind = MESSAGE_KIND_APPEND;
+  msg->seq = next_seq++;
+  current_seq = msg->seq;
+  current_collapsed = false;
+  post(msg);
+}
+
+static void on_line(message_t *msg, void *ctx) {
+  int64_t now = esp_timer_get_time();
+
+  stats.lines++;
+  if (echo_enabled) {
+    printf("%s\n", msg->data);
+  }
+
+  // rates are counted before collapsing, repeats are what floods the link
+  log_stats_add(tag_stats, msg->data, msg->len, now);
+  boot_timeline_feed_line(&boot_timeline, msg->data, now);
+
+  msg->format = MESSAGE_FORMAT_TEXT;
+  publish(msg, now, 0);
+}
+
+static void on_text(const uint8_t *data, size_t len, void *ctx) { log_framer_feed(&framer, data, len); }
+
+// Dictionary records are only split and counted here, the text is produced
+// by the UI for the rows it actually shows
+static void on_record(const zlog_record_t *record, const uint8_t *package, size_t package_len, void *ctx) {
+  static const log_stats_level_t levels[] = {LOG_STATS_LEVEL_NONE, LOG_STATS_LEVEL_ERROR, LOG_STATS_LEVEL_WARN, LOG_STATS_LEVEL_INFO, LOG_STATS_LEVEL_DEBUG};
+  static message_t msg;
+  int64_t now = esp_timer_get_time();
+
+  stats.lines++;
+  msg.kind = MESSAGE_KIND_APPEND;
+
+  if (package == NULL) {
+    msg.format = MESSAGE_FORMAT_TEXT;
+    msg.len = snprintf(msg.data, MAX_MESSAGE_LEN, "<%u messages dropped by target>", record->dropped);
+    publish(&msg, now, 0);
+    return;
+  }
+
+  const char *source = zlog_dict_source_name(record->source);
+  char tag[LOG_STATS_TAG_LEN];
+  if (source == NULL) {
+    snprintf(tag, sizeof(tag), "0x%08lx", (unsigned long)record->source);
+    source = tag;
+  }
+  log_stats_add_tagged(tag_stats, source, record->level < 5 ? levels[record->level] : LOG_STATS_LEVEL_NONE, package_len, now);
+
+  if (package_len > MAX_MESSAGE_LEN - sizeof(zlog_record_t)) {
+    package_len = MAX_MESSAGE_LEN - sizeof(zlog_record_t);
+  }
+  msg.format = MESSAGE_FORMAT_ZLOG;
+  memcpy(msg.data, record, sizeof(zlog_record_t));
+  memcpy(msg.data + sizeof(zlog_record_t), package, package_len);
+  msg.len = sizeof(zlog_record_t) + package_len;
+  // the timestamp differs for every record, repeats are detected on the rest
+  publish(&msg, now, offsetof(zlog_record_t, source));
+}
+
+static void flush_timer_cb(void *arg) {
+  // retry later if a source is feeding rather than stall the timer task
+  if (xSemaphoreTake(pipeline_mutex, 0) != pdTRUE) {
+    arm_flush();
+    return;
+  }
+  // armed one report period after the first suppressed repeat, everything
+  // still pending is due
+  flush_repeats(esp_timer_get_time(), 0);
+  notify_if_queued();
+  xSemaphoreGive(pipeline_mutex);
+}
+
+void log_pipeline_init(void *queue) {
+  message_queue = (QueueHandle_t)queue;
+  memset(&stats, 0, sizeof(stats));
+  log_framer_init(&framer, on_line, NULL);
+  zlog_decoder_init(&zlog_decoder, ZLOG_DICT_STREAM_HEX, zlog_dict_timestamp_64(), on_record, on_text, NULL);
+  // the binary backend writes no sync magic, a loaded dictionary is the only
+  // hint that records are to be expected
+  zlog_decoder_set_unsynced(&zlog_decoder, zlog_dict_loaded());
+  log_dedup_init(&dedup);
+  boot_timeline_init(&boot_timeline, NULL, 0);
+
+  tag_stats = heap_caps_malloc(sizeof(log_stats_t), MALLOC_CAP_SPIRAM);
+  assert(tag_stats != NULL);
+  log_stats_init(tag_stats);
+
+  pipeline_mutex = xSemaphoreCreateMutex();
+  assert(pipeline_mutex != NULL);
+
+  const esp_timer_create_args_t timer_args = {
+      .callback = flush_timer_cb,
+      .name = "log_flush",
+  };
+  ESP_ERROR_CHECK(esp_timer_create(&timer_args, &flush_timer));
+}
+
+void log_pipeline_set_consumer(void *task) { consumer = (TaskHandle_t)task; }
+
+void log_pipeline_feed(const uint8_t *data, size_t len) {
+  if (message_queue == NULL) {
+    return;
+  }
+  xSemaphoreTake(pipeline_mutex, portMAX_DELAY);
+  stats.bytes += len;
+  zlog_decoder_feed(&zlog_decoder, data, len);
+  notify_if_queued();
+  xSemaphoreGive(pipeline_mutex);
+}
+
+void log_pipeline_set_echo(bool enable) { echo_enabled = enable; }
+
+void log_pipeline_get_stats(log_pipeline_stats_t *out) { *out = stats; }
+
+size_t log_pipeline_get_tag_stats(log_stats_row_t *rows, size_t max_rows) {
+  xSemaphoreTake(pipeline_mutex, portMAX_DELAY);
+  size_t count = log_stats_snapshot(tag_stats, esp_timer_get_time(), rows, max_rows);
+  xSemaphoreGive(pipeline_mutex);
+  return count;
+}
+
+void log_pipeline_set_boot_milestones(const boot_milestone_t *milestones, size_t count) {
+  xSemaphoreTake(pipeline_mutex, portMAX_DELAY);
+  boot_timeline_init(&boot_timeline, milestones, count);
+  xSemaphoreGive(pipeline_mutex);
+}
+
+void log_pipeline_get_boot_timeline(boot_timeline_t *timeline) {
+  xSemaphoreTake(pipeline_mutex, portMAX_DELAY);
+  *timeline = boot_timeline;
+  xSemaphoreGive(pipeline_mutex);
+}
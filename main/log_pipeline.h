@@ -0,0 +1,99 @@
+/*
+ * SPDX-FileCopyrightText: 2022-2024 Espressif Systems (Shanghai) CO LTD
+ *
+ * SPDX-License-Identifier: CC0-1.0
+ */
+
+#ifndef LOG_PIPELINE_H
+#define LOG_PIPELINE_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#include "boot_timeline.h"
+#include "log_stats.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @brief Counters maintained by the pipeline
+ */
+typedef struct {
+  uint64_t bytes;   /*!< Raw bytes fed into the framer */
+  uint32_t lines;   /*!< Lines produced by the framer */
+  uint32_t rows;    /*!< Distinct rows after collapsing repeated lines */
+  uint32_t dropped; /*!< Messages lost because the message queue was full */
+  uint32_t queue_peak; /*!< Highest message queue fill seen after a post */
+} log_pipeline_stats_t;
+
+/**
+ * @brief Attach the pipeline to the UI message queue
+ *
+ * Must be called before any source (USB, synthetic) starts feeding data and
+ * after zlog_dict_load(), which determines the dictionary record layout.
+ *
+ * @param message_queue Queue of message_t consumed by the UI task
+ */
+void log_pipeline_init(void *message_queue);
+
+/**
+ * @brief Set the task woken when messages are queued
+ *
+ * The task receives one notification (xTaskNotifyGive) per fed chunk that
+ * queued at least one message, so it can block in ulTaskNotifyTake() instead
+ * of polling the queue.
+ *
+ * @param task TaskHandle_t of the consumer, NULL to disable notifications
+ */
+void log_pipeline_set_consumer(void *task);
+
+/**
+ * @brief Feed raw received bytes into the pipeline
+ *
+ * This is the single entry point for all byte sources. Text goes through the
+ * line framer until a Zephyr dictionary logging sync marker switches the
+ * stream to binary records, see zlog_decoder.h. Framed lines are
+ * posted to the message queue without blocking; lines that do not fit are
+ * counted as dropped. A line matching one of the last few distinct lines is
+ * not posted again, the row it first appeared in gets a MESSAGE_KIND_REPEAT
+ * update instead, rate limited per row.
+ */
+void log_pipeline_feed(const uint8_t *data, size_t len);
+
+/**
+ * @brief Enable or disable echoing every framed line to the console
+ */
+void log_pipeline_set_echo(bool enable);
+
+/**
+ * @brief Get a snapshot of the pipeline counters
+ */
+void log_pipeline_get_stats(log_pipeline_stats_t *stats);
+
+/**
+ * @brief Get the current per tag and level line rates
+ *
+ * @return Number of rows written
+ */
+size_t log_pipeline_get_tag_stats(log_stats_row_t *rows, size_t max_rows);
+
+/**
+ * @brief Set the milestones text lines are matched against, see boot_timeline.h
+ *
+ * Clears the boot history. The table must stay valid while the pipeline runs.
+ */
+void log_pipeline_set_boot_milestones(const boot_milestone_t *milestones, size_t count);
+
+/**
+ * @brief Get a copy of the boot history
+ */
+void log_pipeline_get_boot_timeline(boot_timeline_t *timeline);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // LOG_PIPELINE_H
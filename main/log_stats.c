@@ -0,0 +1,232 @@
+/*
+ * SPDX-FileCopyrightText: 2022-2024 Espressif Systems (Shanghai) CO LTD
+ *
+ * SPDX-License-Identifier: CC0-1.0
+ */
+
+#include <string.h>
+
+#include "log_stats.h"
+
+static const char level_chars[LOG_STATS_LEVEL_COUNT] = {' ', 'E', 'W', 'I', 'D', 'V'};
+
+static log_stats_level_t level_from_char(char c) {
+  for (int i = LOG_STATS_LEVEL_ERROR; i < LOG_STATS_LEVEL_COUNT; i++) {
+    if (level_chars[i] == c) {
+      return (log_stats_level_t)i;
+    }
+  }
+  return LOG_STATS_LEVEL_NONE;
+}
+
+static bool is_ident(char c) { return (c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z') || (c >= '0' && c <= '9') || c == '_' || c == '.' || c == '-'; }
+
+static void copy_tag(char *tag, size_t tag_size, const char *src, size_t len) {
+  if (len >= tag_size) {
+    len = tag_size - 1;
+  }
+  memcpy(tag, src, len);
+  tag[len] = '\0';
+}
+
+// "<inf> module: text"
+static log_stats_level_t parse_zephyr(const char *p, const char *end, char *tag, size_t tag_size) {
+  static const char *const names[] = {"err", "wrn", "inf", "dbg"};
+  static const log_stats_level_t levels[] = {LOG_STATS_LEVEL_ERROR, LOG_STATS_LEVEL_WARN, LOG_STATS_LEVEL_INFO, LOG_STATS_LEVEL_DEBUG};
+
+  if (end - p < 6 || p[0] != '<' || p[4] != '>' || p[5] != ' ') {
+    return LOG_STATS_LEVEL_NONE;
+  }
+  for (int i = 0; i < 4; i++) {
+    if (memcmp(p + 1, names[i], 3) == 0) {
+      const char *t = p + 6;
+      const char *t_end = t;
+      while (t_end < end && *t_end != ':' && *t_end != ' ') {
+        t_end++;
+      }
+      copy_tag(tag, tag_size, t, t_end - t);
+      return levels[i];
+    }
+  }
+  return LOG_STATS_LEVEL_NONE;
+}
+
+log_stats_level_t log_stats_parse(const char *line, size_t len, char *tag, size_t tag_size) {
+  const char *end = line + len;
+  const char *p = line;
+
+  copy_tag(tag, tag_size, "-", 1);
+
+  if (len >= 3 && line[0] == '[') {
+    // Zephyr timestamp prefix
+    p = memchr(line, ']', len);
+    if (p == NULL || end - p < 2) {
+      return LOG_STATS_LEVEL_NONE;
+    }
+    return parse_zephyr(p + 2, end, tag, tag_size);
+  }
+  if (len >= 1 && line[0] == '<') {
+    return parse_zephyr(p, end, tag, tag_size);
+  }
+
+  if (len < 3) {
+    return LOG_STATS_LEVEL_NONE;
+  }
+  log_stats_level_t level = level_from_char(line[0]);
+  if (level == LOG_STATS_LEVEL_NONE) {
+    return LOG_STATS_LEVEL_NONE;
+  }
+
+  if (line[1] == ' ' && line[2] == '(') {
+    // ESP-IDF: "I (4846) HEX: ..."
+    p = memchr(line, ')', len);
+    if (p == NULL || end - p < 2 || p[1] != ' ') {
+      return LOG_STATS_LEVEL_NONE;
+    }
+    const char *t = p + 2;
+    const char *t_end = memchr(t, ':', end - t);
+    if (t_end == NULL) {
+      return LOG_STATS_LEVEL_NONE;
+    }
+    copy_tag(tag, tag_size, t, t_end - t);
+    return level;
+  }
+
+  if (line[1] == ' ') {
+    // ESP-IDF without timestamps (CONFIG_LOG_TIMESTAMP_SOURCE_NONE) and
+    // early startup: "I esp_psram: ...". The tag must be short and end in
+    // ": " so plain text that happens to start with "I " is not mistaken
+    // for it.
+    const char *t = line + 2;
+    const char *t_end = memchr(t, ':', end - t);
+    if (t_end == NULL || t_end == t || t_end - t >= LOG_STATS_TAG_LEN || (t_end + 1 < end && t_end[1] != ' ')) {
+      return LOG_STATS_LEVEL_NONE;
+    }
+    copy_tag(tag, tag_size, t, t_end - t);
+    return level;
+  }
+
+  if (line[1] == ':' && line[2] == ' ') {
+    // Zephyr minimal / MCUboot: "D: context_boot_go", debug lines start with
+    // the function name. Anything else is attributed to the image as a whole.
+    const char *t = line + 3;
+    const char *t_end = t;
+    while (t_end < end && is_ident(*t_end)) {
+      t_end++;
+    }
+    if (t_end > t && (t_end == end || *t_end == ':')) {
+      copy_tag(tag, tag_size, t, t_end - t);
+    } else {
+      copy_tag(tag, tag_size, "zephyr", 6);
+    }
+    return level;
+  }
+
+  return LOG_STATS_LEVEL_NONE;
+}
+
+static uint32_t hash_key(const char *tag, uint8_t level) {
+  // FNV-1a
+  uint32_t hash = 2166136261u ^ level;
+  hash *= 16777619u;
+  for (const char *c = tag; *c; c++) {
+    hash ^= (uint8_t)*c;
+    hash *= 16777619u;
+  }
+  return hash;
+}
+
+static log_stats_entry_t *lookup(log_stats_t *stats, const char *tag, uint8_t level) {
+  uint32_t index = hash_key(tag, level) & (LOG_STATS_TABLE_SIZE - 1);
+
+  for (int probe = 0; probe < LOG_STATS_MAX_PROBES; probe++) {
+    log_stats_entry_t *entry = &stats->entries[(index + probe) & (LOG_STATS_TABLE_SIZE - 1)];
+    if (!entry->used) {
+      entry->used = true;
+      entry->level = level;
+      strcpy(entry->tag, tag);
+      return entry;
+    }
+    if (entry->level == level && strcmp(entry->tag, tag) == 0) {
+      return entry;
+    }
+  }
+  return &stats->overflow;
+}
+
+void log_stats_init(log_stats_t *stats) {
+  memset(stats, 0, sizeof(*stats));
+  stats->overflow.used = true;
+  copy_tag(stats->overflow.tag, LOG_STATS_TAG_LEN, "(other)", 7);
+}
+
+void log_stats_add(log_stats_t *stats, const char *line, size_t len, int64_t now_us) {
+  char tag[LOG_STATS_TAG_LEN];
+  log_stats_level_t level = log_stats_parse(line, len, tag, sizeof(tag));
+  log_stats_add_tagged(stats, tag, level, len, now_us);
+}
+
+void log_stats_add_tagged(log_stats_t *stats, const char *tag, log_stats_level_t level, size_t len, int64_t now_us) {
+  char key[LOG_STATS_TAG_LEN];
+  copy_tag(key, sizeof(key), tag, strlen(tag));
+  log_stats_entry_t *entry = lookup(stats, key, level);
+
+  uint32_t sec = now_us / 1000000;
+  uint32_t slot = sec % LOG_STATS_WINDOW_SEC;
+  if (entry->bucket_sec[slot] != sec) {
+    entry->bucket_sec[slot] = sec;
+    entry->buckets[slot].lines = 0;
+    entry->buckets[slot].bytes = 0;
+  }
+  entry->buckets[slot].lines++;
+  entry->buckets[slot].bytes += len;
+  entry->total_lines++;
+  entry->total_bytes += len;
+}
+
+static bool snapshot_entry(const log_stats_entry_t *entry, uint32_t now_sec, log_stats_row_t *row) {
+  uint64_t lines = 0;
+  uint64_t bytes = 0;
+
+  memcpy(row->tag, entry->tag, LOG_STATS_TAG_LEN);
+  row->level = entry->level;
+  row->lines_1s = 0;
+  row->bytes_1s = 0;
+  row->total_lines = entry->total_lines;
+
+  // the current second is still filling up, the window ends before it
+  for (uint32_t age = 1; age <= LOG_STATS_WINDOW_SEC && age <= now_sec; age++) {
+    uint32_t sec = now_sec - age;
+    uint32_t slot = sec % LOG_STATS_WINDOW_SEC;
+    if (entry->bucket_sec[slot] != sec) {
+      continue;
+    }
+    if (age == 1) {
+      row->lines_1s = entry->buckets[slot].lines;
+      row->bytes_1s = entry->buckets[slot].bytes;
+    }
+    lines += entry->buckets[slot].lines;
+    bytes += entry->buckets[slot].bytes;
+  }
+  row->lines_window = (float)lines / LOG_STATS_WINDOW_SEC;
+  row->bytes_window = (float)bytes / LOG_STATS_WINDOW_SEC;
+
+  return entry->total_lines > 0;
+}
+
+size_t log_stats_snapshot(const log_stats_t *stats, int64_t now_us, log_stats_row_t *rows, size_t max_rows) {
+  uint32_t now_sec = now_us / 1000000;
+  size_t count = 0;
+
+  for (size_t i = 0; i < LOG_STATS_TABLE_SIZE && count < max_rows; i++) {
+    if (stats->entries[i].used && snapshot_entry(&stats->entries[i], now_sec, &rows[count])) {
+      count++;
+    }
+  }
+  if (count < max_rows && snapshot_entry(&stats->overflow, now_sec, &rows[count])) {
+    count++;
+  }
+  return count;
+}
+
+char log_stats_level_char(log_stats_level_t level) { return level < LOG_STATS_LEVEL_COUNT ? level_chars[level] : ' '; }
@@ -0,0 +1,116 @@
+/*
+ * SPDX-FileCopyrightText: 2022-2024 Espressif Systems (Shanghai) CO LTD
+ *
+ * SPDX-License-Identifier: CC0-1.0
+ */
+
+#ifndef LOG_STATS_H
+#define LOG_STATS_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define LOG_STATS_TAG_LEN (24)
+#define LOG_STATS_TABLE_SIZE (128) // power of two
+#define LOG_STATS_MAX_PROBES (8)
+#define LOG_STATS_WINDOW_SEC (10)
+
+typedef enum {
+  LOG_STATS_LEVEL_NONE,
+  LOG_STATS_LEVEL_ERROR,
+  LOG_STATS_LEVEL_WARN,
+  LOG_STATS_LEVEL_INFO,
+  LOG_STATS_LEVEL_DEBUG,
+  LOG_STATS_LEVEL_VERBOSE,
+  LOG_STATS_LEVEL_COUNT,
+} log_stats_level_t;
+
+typedef struct {
+  uint32_t lines;
+  uint32_t bytes;
+} log_stats_bucket_t;
+
+/**
+ * @brief Counters of one tag and level pair
+ *
+ * One bucket per second of the sliding window; a bucket is reset lazily when
+ * its second comes round again.
+ */
+typedef struct {
+  char tag[LOG_STATS_TAG_LEN];
+  uint8_t level;
+  bool used;
+  uint32_t bucket_sec[LOG_STATS_WINDOW_SEC];
+  log_stats_bucket_t buckets[LOG_STATS_WINDOW_SEC];
+  uint64_t total_lines;
+  uint64_t total_bytes;
+} log_stats_entry_t;
+
+/**
+ * @brief Fixed-size open addressing table of per-tag counters
+ *
+ * Tags that do not fit (table full or too many collisions) are counted under
+ * an overflow entry. Does not depend on FreeRTOS so it can be built on the
+ * host; the caller serializes access.
+ */
+typedef struct {
+  log_stats_entry_t entries[LOG_STATS_TABLE_SIZE];
+  log_stats_entry_t overflow;
+} log_stats_t;
+
+/**
+ * @brief Rates of one tag and level pair at the time of a snapshot
+ */
+typedef struct {
+  char tag[LOG_STATS_TAG_LEN];
+  uint8_t level;
+  uint32_t lines_1s; /*!< Lines in the last complete second */
+  uint32_t bytes_1s;
+  float lines_window; /*!< Average lines/s over LOG_STATS_WINDOW_SEC */
+  float bytes_window;
+  uint64_t total_lines;
+} log_stats_row_t;
+
+void log_stats_init(log_stats_t *stats);
+
+/**
+ * @brief Extract the level and tag of a line
+ *
+ * Understands ESP-IDF with or without timestamp ("I (4846) HEX: ...",
+ * "I esp_psram: ..."), Zephyr ("[00:00:01.000,000] <inf> net: ...") and
+ * Zephyr minimal / MCUboot ("D: context_boot_go") prefixes. Lines without a known prefix get LOG_STATS_LEVEL_NONE and "-".
+ */
+log_stats_level_t log_stats_parse(const char *line, size_t len, char *tag, size_t tag_size);
+
+/**
+ * @brief Count a line, O(1)
+ */
+void log_stats_add(log_stats_t *stats, const char *line, size_t len, int64_t now_us);
+
+/**
+ * @brief Count a record whose level and tag are already known, O(1)
+ */
+void log_stats_add_tagged(log_stats_t *stats, const char *tag, log_stats_level_t level, size_t len, int64_t now_us);
+
+/**
+ * @brief Compute rates for every tag and level pair seen so far
+ *
+ * @return Number of rows written
+ */
+size_t log_stats_snapshot(const log_stats_t *stats, int64_t now_us, log_stats_row_t *rows, size_t max_rows);
+
+/**
+ * @brief Single character name of a level, ' ' for none
+ */
+char log_stats_level_char(log_stats_level_t level);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // LOG_STATS_H
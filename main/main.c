@@ -8,6 +8,9 @@
 #include <string.h>
 
 #include "esp_log.h"
+#if CONFIG_PM_ENABLE
+#include "esp_pm.h"
+#endif
 #include "freertos/FreeRTOS.h"
 #include "freertos/semphr.h"
 #include "freertos/task.h"
@@ -17,9 +20,47 @@
 #include "bsp_board_extra.h"
 #include "lvgl.h"
 
+#include "log_pipeline.h"
 #include "messaging.h"
+#include "raw_capture.h"
+#include "storage.h"
+#include "synth_source.h"
+#include "sys_monitor.h"
 #include "ui_task.h"
 #include "usb_task.h"
+#include "zlog_dict.h"
+
+// Drive the pipeline from the built-in synthetic source instead of a USB
+// target, see synth_source.h
+#define LOG_SOURCE_SYNTHETIC (0)
+// Replay the embedded sample.txt instead of generating pattern lines
+#define LOG_SOURCE_SYNTHETIC_REPLAY (0)
+// Raise the synthetic rate until lines are dropped and log the maximum
+#define LOG_SOURCE_SYNTHETIC_RAMP (1)
+// Replay a raw capture instead of reading a USB target
+#define LOG_SOURCE_REPLAY (0)
+#define LOG_SOURCE_REPLAY_FILE "capture_000.ulr"
+// 1 for real time, N for N times faster, 0 for as fast as possible
+#define LOG_SOURCE_REPLAY_SPEED (1)
+// Record the raw byte stream of every USB connection, see raw_capture.h
+#define LOG_RAW_CAPTURE (0)
+// Sample stack, CPU, heap and queue usage and show it on an overlay
+#define LOG_SYS_MONITOR (0)
+// Also write every sample to sysmon_NNN.csv, see sys_monitor.h
+#define LOG_SYS_MONITOR_CSV (0)
+
+// Boot milestones in boot order, see boot_timeline.h. These match MCUboot
+// followed by a Zephyr application; MCUboot and the application both print
+// "Using Zephyr OS", the order tells them apart.
+static const boot_milestone_t boot_milestones[] = {
+    {"MCUboot", "*** Booting MCUboot", true},
+    {"MCUboot init", "*** Using Zephyr OS", false},
+    {"Bootloader", "Starting bootloader", true},
+    {"Validate", "bootutil_img_validate", false},
+    {"Jump", "Jumping to the first image slot", false},
+    {"Zephyr", "*** Booting Zephyr OS", true},
+    {"Application", "*** Using Zephyr OS", false},
+};
 
 static QueueHandle_t message_queue = NULL;
 
@@ -28,6 +69,47 @@ void app_main(void) {
   message_queue = xQueueCreate(MESSAGE_QUEUE_SIZE, sizeof(message_t));
   assert(message_queue != NULL);
 
+#if CONFIG_PM_ENABLE
+  // the UI holds a lock while it renders, see ui_task.c
+  esp_pm_config_t pm_config = {
+      .max_freq_mhz = CONFIG_ESP_DEFAULT_CPU_FREQ_MHZ,
+      .min_freq_mhz = CONFIG_XTAL_FREQ,
+#if CONFIG_FREERTOS_USE_TICKLESS_IDLE
+      .light_sleep_enable = true,
+#endif
+  };
+  ESP_ERROR_CHECK(esp_pm_configure(&pm_config));
+#endif
+
+  storage_init();
+  // optional, only needed for targets using Zephyr dictionary logging
+  zlog_dict_load();
+
+  log_pipeline_init(message_queue);
+  log_pipeline_set_boot_milestones(boot_milestones, sizeof(boot_milestones) / sizeof(boot_milestones[0]));
+#if LOG_SYS_MONITOR
+  // before the UI, which only creates the overlay when the monitor runs
+  sys_monitor_start(message_queue, LOG_SYS_MONITOR_CSV);
+#endif
   ui_task_start(message_queue);
+
+#if LOG_SOURCE_SYNTHETIC
+#if LOG_SOURCE_SYNTHETIC_REPLAY
+  synth_config_t synth_cfg = synth_source_sample_replay(11520);
+#else
+  synth_config_t synth_cfg = {
+      .mode = SYNTH_MODE_PATTERN,
+      .line_len = 80,
+      .lines_per_sec = 100,
+      .ansi_percent = 50,
+      .ftdi_max_packet = SYNTH_FTDI_MAX_PACKET,
+  };
+#endif
+  synth_source_start(&synth_cfg, LOG_SOURCE_SYNTHETIC_RAMP);
+#elif LOG_SOURCE_REPLAY
+  raw_capture_replay_start(LOG_SOURCE_REPLAY_FILE, LOG_SOURCE_REPLAY_SPEED);
+#else
+  raw_capture_enable(LOG_RAW_CAPTURE);
   usb_task_start(message_queue);
+#endif
 }
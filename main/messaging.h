@@ -16,11 +16,36 @@ extern "C" {
 
 #define MESSAGE_QUEUE_SIZE (50)
 #define MAX_MESSAGE_LEN (256)
+// Rows kept in the log view, older rows are deleted
+#define MAX_LOG_ROWS (50)
+
+/**
+ * @brief How a message is applied to the log view
+ */
+typedef enum {
+  MESSAGE_KIND_APPEND,  /*!< Add a new row */
+  MESSAGE_KIND_REPLACE, /*!< Overwrite the last row, e.g. after a bare CR */
+  MESSAGE_KIND_REPEAT,  /*!< Update the repeat counter of row seq, data is empty */
+} message_kind_t;
+
+/**
+ * @brief Encoding of the message data
+ */
+typedef enum {
+  MESSAGE_FORMAT_TEXT, /*!< NUL terminated text */
+  MESSAGE_FORMAT_ZLOG, /*!< zlog_record_t followed by a cbprintf package, see zlog_dict.h */
+} message_format_t;
 
 /**
  * @brief Message structure for the queue
  */
 typedef struct {
+  uint8_t kind;     /*!< message_kind_t */
+  uint8_t format;   /*!< message_format_t */
+  uint32_t seq;     /*!< Row id, assigned to every appended row */
+  uint32_t repeat;  /*!< Occurrences of the row text, 1 unless collapsed */
+  int64_t first_us; /*!< Arrival time of the first occurrence */
+  int64_t last_us;  /*!< Arrival time of the latest occurrence */
   char data[MAX_MESSAGE_LEN];
   size_t len;
 } message_t;
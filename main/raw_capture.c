@@ -0,0 +1,240 @@
+/*
+ * SPDX-FileCopyrightText: 2022-2024 Espressif Systems (Shanghai) CO LTD
+ *
+ * SPDX-License-Identifier: CC0-1.0
+ */
+
+#include <stdio.h>
+#include <string.h>
+
+#include "esp_heap_caps.h"
+#include "esp_log.h"
+#include "esp_timer.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/ringbuf.h"
+#include "freertos/semphr.h"
+#include "freertos/task.h"
+
+#include "log_pipeline.h"
+#include "raw_capture.h"
+#include "rawcap.h"
+#include "storage.h"
+#include "vcp_rx.h"
+
+#define RAW_CAPTURE_BUFFER_SIZE (64 * 1024)
+#define RAW_CAPTURE_FLUSH_MS (1000)
+#define RAW_CAPTURE_MAX_CHUNK (1024)
+// Time raw_capture_stop() waits for the writer to drain the buffer
+#define RAW_CAPTURE_STOP_TIMEOUT_MS (5000)
+
+static const char *TAG = "raw_capture";
+
+static bool capture_enabled = false;
+static volatile bool recording = false;
+static RingbufHandle_t ring = NULL;
+static SemaphoreHandle_t writer_done = NULL;
+static FILE *capture_file = NULL;
+static int64_t last_chunk_us = 0;
+static uint32_t lost_chunks = 0;
+
+typedef struct {
+  char path[64];
+  uint32_t speed;
+} replay_args_t;
+
+static replay_args_t replay_args;
+
+static void writer_task(void *arg) {
+  int64_t last_flush = esp_timer_get_time();
+
+  while (1) {
+    size_t size;
+    void *item = xRingbufferReceive(ring, &size, pdMS_TO_TICKS(100));
+    if (item != NULL) {
+      fwrite(item, 1, size, capture_file);
+      vRingbufferReturnItem(ring, item);
+    } else if (!recording) {
+      // stopped and drained
+      fclose(capture_file);
+      capture_file = NULL;
+      break;
+    }
+
+    // checked after every write too, a steady stream never leaves the
+    // receive idle
+    if (esp_timer_get_time() - last_flush > RAW_CAPTURE_FLUSH_MS * 1000LL) {
+      fflush(capture_file);
+      last_flush = esp_timer_get_time();
+    }
+  }
+
+  xSemaphoreGive(writer_done);
+  vTaskDelete(NULL);
+}
+
+void raw_capture_enable(bool enable) { capture_enabled = enable; }
+
+esp_err_t raw_capture_start(uint8_t driver, uint16_t max_packet) {
+  if (!capture_enabled) {
+    return ESP_OK;
+  }
+  if (recording || capture_file != NULL) {
+    ESP_LOGW(TAG, "Previous capture still open, this connection is not recorded");
+    return ESP_ERR_INVALID_STATE;
+  }
+
+  char path[64];
+  if (!storage_new_path(RAW_CAPTURE_FILE_FMT, RAW_CAPTURE_MAX_FILES, path, sizeof(path))) {
+    ESP_LOGE(TAG, "No room for a new capture");
+    return ESP_ERR_NOT_FOUND;
+  }
+
+  if (ring == NULL) {
+    ring = xRingbufferCreateWithCaps(RAW_CAPTURE_BUFFER_SIZE, RINGBUF_TYPE_NOSPLIT, MALLOC_CAP_SPIRAM);
+  }
+  if (writer_done == NULL) {
+    writer_done = xSemaphoreCreateBinary();
+  }
+  if (ring == NULL || writer_done == NULL) {
+    return ESP_ERR_NO_MEM;
+  }
+
+  // a writer that outlived the wait in raw_capture_stop() has given the
+  // semaphore since, it must not end the wait for the writer started below
+  xSemaphoreTake(writer_done, 0);
+
+  // drop chunks a callback still queued after the previous stop
+  size_t stale_size;
+  void *stale;
+  while ((stale = xRingbufferReceive(ring, &stale_size, 0)) != NULL) {
+    vRingbufferReturnItem(ring, stale);
+  }
+
+  capture_file = fopen(path, "wb");
+  if (capture_file == NULL) {
+    ESP_LOGE(TAG, "Cannot create %s", path);
+    return ESP_FAIL;
+  }
+
+  uint8_t header[RAWCAP_HEADER_LEN];
+  rawcap_header_t info = {
+      .version = RAWCAP_VERSION,
+      .driver = driver,
+      .max_packet = max_packet,
+      .start_us = esp_timer_get_time(),
+  };
+  rawcap_encode_header(header, &info);
+  fwrite(header, 1, sizeof(header), capture_file);
+
+  last_chunk_us = info.start_us;
+  lost_chunks = 0;
+  recording = true;
+
+  BaseType_t writer_task_created = xTaskCreate(writer_task, "capture", 4096, NULL, tskIDLE_PRIORITY + 1, NULL);
+  assert(writer_task_created == pdTRUE);
+
+  ESP_LOGI(TAG, "Recording to %s", path);
+  return ESP_OK;
+}
+
+void raw_capture_record(const uint8_t *data, size_t len) {
+  if (!recording) {
+    return;
+  }
+
+  int64_t now = esp_timer_get_time();
+  int64_t delta = now - last_chunk_us;
+  last_chunk_us = now;
+
+  uint8_t chunk_header[RAWCAP_CHUNK_HEADER_MAX];
+  size_t header_len = rawcap_encode_chunk_header(chunk_header, delta > UINT32_MAX ? UINT32_MAX : (uint32_t)delta, len);
+
+  // encode straight into the ring buffer, the data callback must not block
+  void *item = NULL;
+  if (xRingbufferSendAcquire(ring, &item, header_len + len, 0) != pdTRUE) {
+    lost_chunks++;
+    return;
+  }
+  memcpy(item, chunk_header, header_len);
+  memcpy((uint8_t *)item + header_len, data, len);
+  xRingbufferSendComplete(ring, item);
+}
+
+void raw_capture_stop(void) {
+  if (!recording) {
+    return;
+  }
+  recording = false;
+
+  // wait for the file to be closed, so a reconnect right after this can
+  // start the next capture
+  if (xSemaphoreTake(writer_done, pdMS_TO_TICKS(RAW_CAPTURE_STOP_TIMEOUT_MS)) != pdTRUE) {
+    ESP_LOGW(TAG, "Capture writer still busy, the next connection is not recorded");
+  }
+  if (lost_chunks != 0) {
+    ESP_LOGW(TAG, "Capture incomplete, %lu chunks lost", (unsigned long)lost_chunks);
+  }
+}
+
+uint32_t raw_capture_lost_chunks(void) { return lost_chunks; }
+
+static void feed_pipeline(const uint8_t *data, size_t len, void *ctx) { log_pipeline_feed(data, len); }
+
+static void replay_task(void *arg) {
+  replay_args_t *args = (replay_args_t *)arg;
+  static rawcap_reader_t reader;
+  static uint8_t chunk[RAW_CAPTURE_MAX_CHUNK];
+  static vcp_rx_t rx;
+
+  if (!rawcap_reader_open(&reader, args->path)) {
+    ESP_LOGE(TAG, "%s is not a capture file", args->path);
+    vTaskDelete(NULL);
+  }
+  vcp_rx_init(&rx, reader.header.driver, reader.header.max_packet, feed_pipeline, NULL);
+
+  int64_t start = esp_timer_get_time();
+  uint64_t recorded_us = 0;
+  uint32_t chunks = 0;
+  uint64_t bytes = 0;
+  uint32_t delta_us;
+  int len;
+
+  while ((len = rawcap_reader_next(&reader, chunk, sizeof(chunk), &delta_us)) >= 0) {
+    recorded_us += delta_us;
+    if (args->speed != 0) {
+      // schedule against the start so delays do not accumulate
+      int64_t due = start + recorded_us / args->speed;
+      int64_t wait = due - esp_timer_get_time();
+      if (wait >= 1000) {
+        vTaskDelay(pdMS_TO_TICKS(wait / 1000));
+      }
+    } else if ((chunks & 0x3f) == 0) {
+      // let lower priority tasks run at full speed too
+      vTaskDelay(1);
+    }
+
+    vcp_rx_feed(&rx, chunk, len);
+    chunks++;
+    bytes += len;
+  }
+  rawcap_reader_close(&reader);
+
+  int64_t elapsed = esp_timer_get_time() - start;
+  ESP_LOGI(TAG, "Replayed %lu chunks, %llu bytes in %lld ms (recorded %llu ms)", (unsigned long)chunks, (unsigned long long)bytes, (long long)(elapsed / 1000),
+           (unsigned long long)(recorded_us / 1000));
+  ESP_LOGI(TAG, "Line errors: %lu overrun, %lu parity, %lu framing, %lu break", (unsigned long)rx.errors.overrun, (unsigned long)rx.errors.parity,
+           (unsigned long)rx.errors.framing, (unsigned long)rx.errors.breaks);
+  vTaskDelete(NULL);
+}
+
+esp_err_t raw_capture_replay_start(const char *name, uint32_t speed) {
+  if (!storage_find(name, replay_args.path, sizeof(replay_args.path))) {
+    ESP_LOGE(TAG, "%s not found", name);
+    return ESP_ERR_NOT_FOUND;
+  }
+  replay_args.speed = speed;
+
+  BaseType_t replay_task_created = xTaskCreate(replay_task, "replay", 4096, &replay_args, tskIDLE_PRIORITY + 1, NULL);
+  assert(replay_task_created == pdTRUE);
+  return ESP_OK;
+}
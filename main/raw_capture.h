@@ -0,0 +1,84 @@
+/*
+ * SPDX-FileCopyrightText: 2022-2024 Espressif Systems (Shanghai) CO LTD
+ *
+ * SPDX-License-Identifier: CC0-1.0
+ */
+
+#ifndef RAW_CAPTURE_H
+#define RAW_CAPTURE_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#include "esp_err.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// Captures are numbered per connection: capture_000.ulr, capture_001.ulr, ...
+#define RAW_CAPTURE_FILE_FMT "capture_%03u.ulr"
+#define RAW_CAPTURE_MAX_FILES (1000)
+
+/**
+ * @brief Enable recording of the raw USB byte stream
+ *
+ * When enabled, every connection started with raw_capture_start() is written
+ * to a new file in the rawcap.h container format.
+ */
+void raw_capture_enable(bool enable);
+
+/**
+ * @brief Open a new capture file for a connection
+ *
+ * Does nothing unless recording is enabled. Call it before the device's first
+ * IN transfer can complete, and raw_capture_stop() once no data callback can
+ * run any more (after disconnection or a failed open), both from the same
+ * task. raw_capture_record() takes no lock against them; a chunk recorded
+ * while raw_capture_stop() runs is either written or dropped by the next
+ * raw_capture_start().
+ *
+ * @param driver vcp_driver_t of the connection, stored in the file header
+ * @param max_packet Bulk IN max packet size, stored in the file header
+ */
+esp_err_t raw_capture_start(uint8_t driver, uint16_t max_packet);
+
+/**
+ * @brief Record one data callback invocation
+ *
+ * Never blocks; chunks that do not fit into the write buffer are counted as
+ * lost. Called from the data callback, see raw_capture_start() for the
+ * calling context.
+ */
+void raw_capture_record(const uint8_t *data, size_t len);
+
+/**
+ * @brief Flush and close the current capture file
+ *
+ * Blocks until everything buffered is written and the file is closed.
+ */
+void raw_capture_stop(void);
+
+/**
+ * @brief Chunks lost since start because the write buffer was full
+ */
+uint32_t raw_capture_lost_chunks(void);
+
+/**
+ * @brief Replay a capture file into the pipeline
+ *
+ * The recorded chunks are fed with their original boundaries, through the
+ * same status stripping as live data for the driver named in the header.
+ *
+ * @param name File name on the SD card or the storage partition
+ * @param speed Time scale, 1 for real time, N for N times faster, 0 for as
+ *              fast as possible
+ */
+esp_err_t raw_capture_replay_start(const char *name, uint32_t speed);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // RAW_CAPTURE_H
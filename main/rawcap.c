@@ -0,0 +1,102 @@
+/*
+ * SPDX-FileCopyrightText: 2022-2024 Espressif Systems (Shanghai) CO LTD
+ *
+ * SPDX-License-Identifier: CC0-1.0
+ */
+
+#include <string.h>
+
+#include "rawcap.h"
+
+static size_t put_varint(uint8_t *out, uint32_t value) {
+  size_t n = 0;
+  while (value >= 0x80) {
+    out[n++] = (value & 0x7f) | 0x80;
+    value >>= 7;
+  }
+  out[n++] = value;
+  return n;
+}
+
+static bool get_varint(FILE *f, uint32_t *value) {
+  uint32_t result = 0;
+  for (int shift = 0; shift < 35; shift += 7) {
+    int c = fgetc(f);
+    if (c == EOF) {
+      return false;
+    }
+    result |= (uint32_t)(c & 0x7f) << shift;
+    if ((c & 0x80) == 0) {
+      *value = result;
+      return true;
+    }
+  }
+  return false;
+}
+
+size_t rawcap_encode_header(uint8_t *out, const rawcap_header_t *header) {
+  memset(out, 0, RAWCAP_HEADER_LEN);
+  memcpy(out, RAWCAP_MAGIC, 4);
+  out[4] = header->version;
+  out[5] = header->driver;
+  out[6] = header->max_packet;
+  out[7] = header->max_packet >> 8;
+  for (int i = 0; i < 8; i++) {
+    out[8 + i] = (uint64_t)header->start_us >> (8 * i);
+  }
+  return RAWCAP_HEADER_LEN;
+}
+
+bool rawcap_decode_header(const uint8_t *in, rawcap_header_t *header) {
+  if (memcmp(in, RAWCAP_MAGIC, 4) != 0 || in[4] != RAWCAP_VERSION) {
+    return false;
+  }
+  header->version = in[4];
+  header->driver = in[5];
+  header->max_packet = in[6] | (uint16_t)in[7] << 8;
+  uint64_t start = 0;
+  for (int i = 0; i < 8; i++) {
+    start |= (uint64_t)in[8 + i] << (8 * i);
+  }
+  header->start_us = (int64_t)start;
+  return true;
+}
+
+size_t rawcap_encode_chunk_header(uint8_t *out, uint32_t delta_us, uint32_t len) {
+  size_t n = put_varint(out, delta_us);
+  return n + put_varint(out + n, len);
+}
+
+bool rawcap_reader_open(rawcap_reader_t *reader, const char *path) {
+  uint8_t raw[RAWCAP_HEADER_LEN];
+
+  reader->f = fopen(path, "rb");
+  if (reader->f == NULL) {
+    return false;
+  }
+  if (fread(raw, 1, sizeof(raw), reader->f) != sizeof(raw) || !rawcap_decode_header(raw, &reader->header)) {
+    fclose(reader->f);
+    reader->f = NULL;
+    return false;
+  }
+  return true;
+}
+
+int rawcap_reader_next(rawcap_reader_t *reader, uint8_t *buf, size_t cap, uint32_t *delta_us) {
+  uint32_t len;
+
+  if (reader->f == NULL || !get_varint(reader->f, delta_us) || !get_varint(reader->f, &len)) {
+    return -1;
+  }
+  if (len > cap || fread(buf, 1, len, reader->f) != len) {
+    return -1;
+  }
+  return len;
+}
+
+void rawcap_reader_close(rawcap_reader_t *reader) {
+  if (reader->f != NULL) {
+    fclose(reader->f);
+    reader->f = NULL;
+  }
+}
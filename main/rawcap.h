@@ -0,0 +1,83 @@
+/*
+ * SPDX-FileCopyrightText: 2022-2024 Espressif Systems (Shanghai) CO LTD
+ *
+ * SPDX-License-Identifier: CC0-1.0
+ */
+
+#ifndef RAWCAP_H
+#define RAWCAP_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdio.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/*
+ * Raw capture container
+ *
+ * A 16 byte header followed by one record per USB data callback:
+ *
+ *   header: "ULVR" | version (1) | driver (1) | max_packet (2, LE) | start_us (8, LE)
+ *   chunk:  delta_us (varint) | len (varint) | len bytes as delivered
+ *
+ * delta_us is the time since the previous chunk, or since start_us for the
+ * first one. Varints are unsigned LEB128. driver and max_packet tell where
+ * in-band adapter status sits in the chunks, see vcp_rx.h; 0 means unknown.
+ */
+
+#define RAWCAP_MAGIC "ULVR"
+#define RAWCAP_VERSION (1)
+#define RAWCAP_HEADER_LEN (16)
+#define RAWCAP_CHUNK_HEADER_MAX (10)
+
+typedef struct {
+  uint8_t version;
+  uint8_t driver;      /*!< vcp_driver_t that delivered the chunks */
+  uint16_t max_packet; /*!< Bulk IN max packet size, 0 if unknown */
+  int64_t start_us;
+} rawcap_header_t;
+
+/**
+ * @brief Serialize the file header into RAWCAP_HEADER_LEN bytes
+ */
+size_t rawcap_encode_header(uint8_t *out, const rawcap_header_t *header);
+
+/**
+ * @brief Parse RAWCAP_HEADER_LEN bytes, false if the magic or version does not match
+ */
+bool rawcap_decode_header(const uint8_t *in, rawcap_header_t *header);
+
+/**
+ * @brief Serialize a chunk header into at most RAWCAP_CHUNK_HEADER_MAX bytes
+ */
+size_t rawcap_encode_chunk_header(uint8_t *out, uint32_t delta_us, uint32_t len);
+
+/**
+ * @brief Sequential reader over a capture file
+ */
+typedef struct {
+  FILE *f;
+  rawcap_header_t header;
+} rawcap_reader_t;
+
+bool rawcap_reader_open(rawcap_reader_t *reader, const char *path);
+
+/**
+ * @brief Read the next chunk
+ *
+ * @return Chunk length, or -1 at the end of the file or on a malformed or
+ *         oversized chunk
+ */
+int rawcap_reader_next(rawcap_reader_t *reader, uint8_t *buf, size_t cap, uint32_t *delta_us);
+
+void rawcap_reader_close(rawcap_reader_t *reader);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // RAWCAP_H
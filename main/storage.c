@@ -0,0 +1,77 @@
+/*
+ * SPDX-FileCopyrightText: 2022-2024 Espressif Systems (Shanghai) CO LTD
+ *
+ * SPDX-License-Identifier: CC0-1.0
+ */
+
+#include <stdio.h>
+#include <sys/stat.h>
+
+#include "esp_log.h"
+
+#include "bsp/esp-bsp.h"
+#include "storage.h"
+
+static const char *TAG = "storage";
+
+static bool spiffs_mounted = false;
+static bool sdcard_mounted = false;
+
+esp_err_t storage_init(void) {
+  esp_err_t err = bsp_spiffs_mount();
+  if (err == ESP_OK) {
+    spiffs_mounted = true;
+  } else {
+    ESP_LOGW(TAG, "Storage partition not mounted: %s", esp_err_to_name(err));
+  }
+
+  err = bsp_sdcard_mount();
+  if (err == ESP_OK) {
+    sdcard_mounted = true;
+  } else {
+    ESP_LOGI(TAG, "No SD card: %s", esp_err_to_name(err));
+  }
+
+  return spiffs_mounted || sdcard_mounted ? ESP_OK : ESP_FAIL;
+}
+
+bool storage_find(const char *name, char *path, size_t size) {
+  struct stat st;
+
+  if (sdcard_mounted) {
+    snprintf(path, size, "%s/%s", BSP_SD_MOUNT_POINT, name);
+    if (stat(path, &st) == 0) {
+      return true;
+    }
+  }
+  if (spiffs_mounted) {
+    snprintf(path, size, "%s/%s", BSP_SPIFFS_MOUNT_POINT, name);
+    if (stat(path, &st) == 0) {
+      return true;
+    }
+  }
+  return false;
+}
+
+bool storage_path(const char *name, char *path, size_t size) {
+  if (sdcard_mounted) {
+    snprintf(path, size, "%s/%s", BSP_SD_MOUNT_POINT, name);
+    return true;
+  }
+  if (spiffs_mounted) {
+    snprintf(path, size, "%s/%s", BSP_SPIFFS_MOUNT_POINT, name);
+    return true;
+  }
+  return false;
+}
+
+bool storage_new_path(const char *fmt, unsigned max_files, char *path, size_t size) {
+  char name[32];
+  for (unsigned index = 0; index < max_files; index++) {
+    snprintf(name, sizeof(name), fmt, index);
+    if (!storage_find(name, path, size)) {
+      return storage_path(name, path, size);
+    }
+  }
+  return false;
+}
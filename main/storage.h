@@ -0,0 +1,61 @@
+/*
+ * SPDX-FileCopyrightText: 2022-2024 Espressif Systems (Shanghai) CO LTD
+ *
+ * SPDX-License-Identifier: CC0-1.0
+ */
+
+#ifndef STORAGE_H
+#define STORAGE_H
+
+#include <stdbool.h>
+#include <stddef.h>
+
+#include "esp_err.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @brief Mount the storage partition and, if inserted, the SD card
+ *
+ * @return
+ *    - ESP_OK: At least one file system is mounted
+ *    - Others: Fail
+ */
+esp_err_t storage_init(void);
+
+/**
+ * @brief Find a file by name, the SD card takes precedence
+ *
+ * @param name File name without mount point
+ * @param path Buffer receiving the full path
+ * @param size Size of path
+ * @return true if the file exists
+ */
+bool storage_find(const char *name, char *path, size_t size);
+
+/**
+ * @brief Build the path a new file should be written to
+ *
+ * Files go to the SD card when it is mounted, the storage partition
+ * otherwise.
+ *
+ * @return false if no file system is mounted
+ */
+bool storage_path(const char *name, char *path, size_t size);
+
+/**
+ * @brief Build the path of the first numbered file that does not exist yet
+ *
+ * @param fmt File name format with one %u conversion, e.g. "capture_%03u.ulr"
+ * @param max_files Number of indices to try
+ * @return false if all indices are taken or no file system is mounted
+ */
+bool storage_new_path(const char *fmt, unsigned max_files, char *path, size_t size);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // STORAGE_H
@@ -0,0 +1,122 @@
+/*
+ * SPDX-FileCopyrightText: 2022-2024 Espressif Systems (Shanghai) CO LTD
+ *
+ * SPDX-License-Identifier: CC0-1.0
+ */
+
+#include <stdio.h>
+#include <string.h>
+
+#include "synth_gen.h"
+
+static const char *const ansi_colors[] = {"\x1b[0;31m", "\x1b[0;32m", "\x1b[0;33m", "\x1b[0;36m"};
+static const char ansi_reset[] = "\x1b[0m";
+
+static uint32_t next_random(synth_gen_t *gen) {
+  // xorshift32
+  uint32_t x = gen->rng;
+  x ^= x << 13;
+  x ^= x >> 17;
+  x ^= x << 5;
+  gen->rng = x;
+  return x;
+}
+
+static void build_line(synth_gen_t *gen) {
+  char *line = (char *)gen->line;
+  size_t len = 0;
+  bool colored = (next_random(gen) % 100) < gen->cfg.ansi_percent;
+
+  if (colored) {
+    const char *color = ansi_colors[gen->seq % (sizeof(ansi_colors) / sizeof(ansi_colors[0]))];
+    memcpy(line, color, strlen(color));
+    len += strlen(color);
+  }
+
+  size_t text_start = len;
+  len += snprintf(line + len, sizeof(gen->line) - len, "I (%lu) SYNTH: #%lu ", (unsigned long)gen->seq, (unsigned long)gen->seq);
+  size_t text_end = text_start + gen->cfg.line_len;
+  while (len < text_end) {
+    line[len] = 'a' + (len - text_start) % 26;
+    len++;
+  }
+  // the prefix may be longer than a very short line_len
+  if (len > text_end && gen->cfg.line_len > 0) {
+    len = text_end;
+  }
+
+  if (colored) {
+    memcpy(line + len, ansi_reset, sizeof(ansi_reset) - 1);
+    len += sizeof(ansi_reset) - 1;
+  }
+  line[len++] = '\r';
+  line[len++] = '\n';
+
+  gen->line_len = len;
+  gen->line_pos = 0;
+  gen->seq++;
+}
+
+static uint8_t next_payload_byte(synth_gen_t *gen) {
+  if (gen->cfg.mode == SYNTH_MODE_REPLAY) {
+    uint8_t byte = gen->cfg.replay_data[gen->replay_pos++];
+    if (gen->replay_pos == gen->cfg.replay_len) {
+      gen->replay_pos = 0;
+    }
+    return byte;
+  }
+
+  if (gen->line_pos == gen->line_len) {
+    build_line(gen);
+  }
+  return gen->line[gen->line_pos++];
+}
+
+void synth_gen_init(synth_gen_t *gen, const synth_config_t *cfg) {
+  memset(gen, 0, sizeof(*gen));
+  gen->cfg = *cfg;
+  gen->rng = 0x2545f491;
+  if (gen->cfg.line_len > SYNTH_MAX_LINE_LEN) {
+    gen->cfg.line_len = SYNTH_MAX_LINE_LEN;
+  }
+  if (gen->cfg.ansi_percent > 100) {
+    gen->cfg.ansi_percent = 100;
+  }
+  if (gen->cfg.mode == SYNTH_MODE_REPLAY && (gen->cfg.replay_data == NULL || gen->cfg.replay_len == 0)) {
+    gen->cfg.mode = SYNTH_MODE_PATTERN;
+  }
+
+  if (gen->cfg.mode == SYNTH_MODE_REPLAY) {
+    gen->bytes_per_sec = gen->cfg.replay_bytes_per_sec;
+  } else {
+    // payload plus CRLF, color sequences are not accounted for
+    gen->bytes_per_sec = gen->cfg.lines_per_sec * (gen->cfg.line_len + 2);
+  }
+}
+
+size_t synth_gen_fill(synth_gen_t *gen, uint8_t *buf, size_t cap) {
+  uint16_t max_packet = gen->cfg.ftdi_max_packet;
+  // the driver already removed the status of the first packet
+  size_t next_status = max_packet > 2 ? max_packet - 2 : SIZE_MAX;
+  size_t n = 0;
+
+  while (n < cap) {
+    if (n == next_status) {
+      buf[n++] = 0x01;
+      // a transfer cannot end inside a status, the stripper drops the stray
+      // first half
+      if (n < cap) {
+        buf[n++] = 0x60;
+      }
+      next_status += max_packet;
+      continue;
+    }
+    buf[n++] = next_payload_byte(gen);
+  }
+
+  return n;
+}
+
+void synth_gen_set_rate(synth_gen_t *gen, uint32_t bytes_per_sec) { gen->bytes_per_sec = bytes_per_sec; }
+
+uint32_t synth_gen_get_rate(const synth_gen_t *gen) { return gen->bytes_per_sec; }
@@ -0,0 +1,84 @@
+/*
+ * SPDX-FileCopyrightText: 2022-2024 Espressif Systems (Shanghai) CO LTD
+ *
+ * SPDX-License-Identifier: CC0-1.0
+ */
+
+#ifndef SYNTH_GEN_H
+#define SYNTH_GEN_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define SYNTH_MAX_LINE_LEN (200)
+#define SYNTH_FTDI_MAX_PACKET (64)
+
+typedef enum {
+  SYNTH_MODE_PATTERN, /*!< Generate numbered log lines */
+  SYNTH_MODE_REPLAY,  /*!< Loop over a captured byte stream */
+} synth_mode_t;
+
+/**
+ * @brief Synthetic log source configuration
+ */
+typedef struct {
+  synth_mode_t mode;
+  uint16_t line_len;             /*!< Printable characters per generated line, at most SYNTH_MAX_LINE_LEN */
+  uint32_t lines_per_sec;        /*!< Line rate in pattern mode */
+  uint8_t ansi_percent;          /*!< Share of lines wrapped in an SGR color sequence, 0-100 */
+  uint16_t ftdi_max_packet;      /*!< Shape chunks like FT23x transfers with this packet size, 0 disables */
+  const uint8_t *replay_data;    /*!< Byte stream looped in replay mode */
+  size_t replay_len;
+  uint32_t replay_bytes_per_sec; /*!< Byte rate in replay mode */
+} synth_config_t;
+
+/**
+ * @brief Generator state, does not depend on FreeRTOS
+ */
+typedef struct {
+  synth_config_t cfg;
+  uint32_t bytes_per_sec;
+  uint32_t seq;
+  uint32_t rng;
+  size_t replay_pos;
+  uint8_t line[SYNTH_MAX_LINE_LEN + 48];
+  size_t line_len;
+  size_t line_pos;
+} synth_gen_t;
+
+/**
+ * @brief Initialize the generator and derive the nominal byte rate
+ */
+void synth_gen_init(synth_gen_t *gen, const synth_config_t *cfg);
+
+/**
+ * @brief Produce the next chunk of the stream
+ *
+ * With ftdi_max_packet set the chunk is laid out like the data of one FT23x
+ * IN transfer: an FTDI status pair (0x01 0x60) at every packet boundary
+ * except the first, see vcp_rx.h.
+ *
+ * @return Number of bytes written, always equal to cap
+ */
+size_t synth_gen_fill(synth_gen_t *gen, uint8_t *buf, size_t cap);
+
+/**
+ * @brief Override the nominal byte rate, e.g. when ramping up
+ */
+void synth_gen_set_rate(synth_gen_t *gen, uint32_t bytes_per_sec);
+
+/**
+ * @brief Nominal byte rate the source should be paced at
+ */
+uint32_t synth_gen_get_rate(const synth_gen_t *gen);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // SYNTH_GEN_H
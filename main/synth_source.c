@@ -0,0 +1,125 @@
+/*
+ * SPDX-FileCopyrightText: 2022-2024 Espressif Systems (Shanghai) CO LTD
+ *
+ * SPDX-License-Identifier: CC0-1.0
+ */
+
+#include <stdio.h>
+#include <string.h>
+
+#include "esp_log.h"
+#include "esp_timer.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+
+#include "log_pipeline.h"
+#include "synth_source.h"
+#include "vcp_rx.h"
+
+#define SYNTH_TICK_MS (10)
+#define SYNTH_CHUNK_SIZE (256)
+#define SYNTH_STEP_MS (2000)
+#define SYNTH_RAMP_NUM (5)
+#define SYNTH_RAMP_DEN (4)
+
+static const char *TAG = "synth";
+
+extern const uint8_t sample_txt_start[] asm("_binary_sample_txt_start");
+extern const uint8_t sample_txt_end[] asm("_binary_sample_txt_end");
+
+typedef struct {
+  synth_config_t cfg;
+  bool ramp;
+} synth_task_args_t;
+
+static synth_task_args_t task_args;
+
+static void feed_pipeline(const uint8_t *data, size_t len, void *ctx) { log_pipeline_feed(data, len); }
+
+static void synth_task(void *arg) {
+  synth_task_args_t *args = (synth_task_args_t *)arg;
+  static synth_gen_t gen;
+  static uint8_t chunk[SYNTH_CHUNK_SIZE];
+  static vcp_rx_t rx;
+
+  synth_gen_init(&gen, &args->cfg);
+  // every chunk is stripped like a USB transfer from an FT23x adapter
+  vcp_rx_init(&rx, args->cfg.ftdi_max_packet != 0 ? VCP_DRIVER_FT23X : VCP_DRIVER_UNKNOWN, args->cfg.ftdi_max_packet, feed_pipeline, NULL);
+  bool ramping = args->ramp;
+  uint32_t best_rate = 0;
+
+  // console output at 115200 would be the bottleneck, not the pipeline
+  log_pipeline_set_echo(false);
+
+  log_pipeline_stats_t last;
+  log_pipeline_get_stats(&last);
+  int64_t step_start = esp_timer_get_time();
+  int64_t last_tick = step_start;
+  uint64_t credit = 0;
+  TickType_t wake = xTaskGetTickCount();
+
+  ESP_LOGI(TAG, "Starting at %lu B/s%s", (unsigned long)synth_gen_get_rate(&gen), ramping ? ", ramping" : "");
+
+  while (1) {
+    vTaskDelayUntil(&wake, pdMS_TO_TICKS(SYNTH_TICK_MS));
+
+    int64_t now = esp_timer_get_time();
+    credit += (uint64_t)synth_gen_get_rate(&gen) * (uint64_t)(now - last_tick);
+    last_tick = now;
+    size_t budget = credit / 1000000;
+    credit %= 1000000;
+
+    while (budget > 0) {
+      size_t n = budget < SYNTH_CHUNK_SIZE ? budget : SYNTH_CHUNK_SIZE;
+      synth_gen_fill(&gen, chunk, n);
+      vcp_rx_feed(&rx, chunk, n);
+      budget -= n;
+    }
+
+    if (now - step_start < SYNTH_STEP_MS * 1000LL) {
+      continue;
+    }
+
+    log_pipeline_stats_t cur;
+    log_pipeline_get_stats(&cur);
+    int64_t elapsed = now - step_start;
+    uint32_t bps = (uint32_t)((cur.bytes - last.bytes) * 1000000 / elapsed);
+    uint32_t lps = (uint32_t)((uint64_t)(cur.lines - last.lines) * 1000000 / elapsed);
+    uint32_t dropped = cur.dropped - last.dropped;
+    uint32_t target = synth_gen_get_rate(&gen);
+    ESP_LOGI(TAG, "target %lu B/s, sustained %lu B/s, %lu lines/s, %lu dropped", (unsigned long)target, (unsigned long)bps, (unsigned long)lps, (unsigned long)dropped);
+
+    if (ramping) {
+      if (dropped == 0 && bps >= target - target / 10) {
+        best_rate = bps;
+        synth_gen_set_rate(&gen, target / SYNTH_RAMP_DEN * SYNTH_RAMP_NUM + 1);
+      } else {
+        ESP_LOGW(TAG, "Max sustained rate before loss: %lu B/s (%s)", (unsigned long)best_rate, dropped ? "queue overflow" : "source saturated");
+        synth_gen_set_rate(&gen, best_rate);
+        ramping = false;
+      }
+    }
+
+    last = cur;
+    step_start = now;
+  }
+
+  vTaskDelete(NULL);
+}
+
+synth_config_t synth_source_sample_replay(uint32_t bytes_per_sec) {
+  synth_config_t cfg = {
+      .mode = SYNTH_MODE_REPLAY,
+      .replay_data = sample_txt_start,
+      .replay_len = sample_txt_end - sample_txt_start,
+      .replay_bytes_per_sec = bytes_per_sec,
+  };
+  return cfg;
+}
+
+void synth_source_start(const synth_config_t *cfg, bool ramp) {
+  task_args.cfg = *cfg;
+  task_args.ramp = ramp;
+  BaseType_t synth_task_created = xTaskCreate(synth_task, "synth", 4096, &task_args, tskIDLE_PRIORITY + 1, NULL);
+  assert(synth_task_created == pdTRUE);
+}
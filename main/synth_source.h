@@ -0,0 +1,42 @@
+/*
+ * SPDX-FileCopyrightText: 2022-2024 Espressif Systems (Shanghai) CO LTD
+ *
+ * SPDX-License-Identifier: CC0-1.0
+ */
+
+#ifndef SYNTH_SOURCE_H
+#define SYNTH_SOURCE_H
+
+#include <stdbool.h>
+
+#include "synth_gen.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @brief Start the synthetic log source task
+ *
+ * The task paces the generator at its configured rate and feeds the output
+ * into log_pipeline_feed(), the same path the USB data callback uses. When
+ * ramp is set, the rate is raised step by step until the pipeline starts
+ * dropping lines and the highest loss-free rate is logged.
+ *
+ * @param cfg Generator configuration, copied by the task
+ * @param ramp Search for the maximum sustained rate
+ */
+void synth_source_start(const synth_config_t *cfg, bool ramp);
+
+/**
+ * @brief Get a synth_config_t replaying the embedded sample.txt capture
+ *
+ * @param bytes_per_sec Replay rate
+ */
+synth_config_t synth_source_sample_replay(uint32_t bytes_per_sec);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // SYNTH_SOURCE_H
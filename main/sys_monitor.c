@@ -0,0 +1,209 @@
+/*
+ * SPDX-FileCopyrightText: 2022-2024 Espressif Systems (Shanghai) CO LTD
+ *
+ * SPDX-License-Identifier: CC0-1.0
+ */
+
+#include <stdio.h>
+#include <string.h>
+
+#include "esp_heap_caps.h"
+#include "esp_log.h"
+#include "esp_timer.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/queue.h"
+#include "freertos/semphr.h"
+#include "freertos/task.h"
+
+#include "log_pipeline.h"
+#include "messaging.h"
+#include "storage.h"
+#include "sys_monitor.h"
+#include "ui_task.h"
+#include "usb_task.h"
+
+#define SYS_MONITOR_PERIOD_MS (1000)
+
+static const char *TAG = "sys_monitor";
+
+static const char *const task_names[SYS_MONITOR_TASK_COUNT] = {"usb_task", "usb_lib", "ui_task", "sys_monitor"};
+static const uint32_t task_stack_sizes[SYS_MONITOR_TASK_COUNT] = {USB_TASK_STACK_SIZE, USB_LIB_TASK_STACK_SIZE, UI_TASK_STACK_SIZE, SYS_MONITOR_STACK_SIZE};
+
+static QueueHandle_t message_queue = NULL;
+static SemaphoreHandle_t sample_mutex = NULL;
+static sys_monitor_sample_t latest;
+static bool sampled = false;
+static FILE *csv_file = NULL;
+
+static TaskHandle_t task_handles[SYS_MONITOR_TASK_COUNT];
+static configRUN_TIME_COUNTER_TYPE last_idle_time[SYS_MONITOR_MAX_CORES];
+static int64_t last_sample_us = 0;
+
+static void sample_cpu(sys_monitor_sample_t *sample, int64_t now) {
+  uint32_t elapsed = (uint32_t)(now - last_sample_us);
+
+  sample->cores = portNUM_PROCESSORS < SYS_MONITOR_MAX_CORES ? portNUM_PROCESSORS : SYS_MONITOR_MAX_CORES;
+  for (uint8_t core = 0; core < sample->cores; core++) {
+    // the run time counter runs on esp_timer, so idle time is in us; the
+    // unsigned difference survives the counter wrapping
+    configRUN_TIME_COUNTER_TYPE idle_time = ulTaskGetRunTimeCounter(xTaskGetIdleTaskHandleForCore(core));
+    uint32_t idle = (uint32_t)(idle_time - last_idle_time[core]);
+    last_idle_time[core] = idle_time;
+
+    uint8_t load = 0;
+    if (elapsed > 0 && idle < elapsed) {
+      load = (uint8_t)(100 - (uint64_t)idle * 100 / elapsed);
+    }
+    sample->cpu_percent[core] = load;
+    if (load > sample->cpu_percent_max[core]) {
+      sample->cpu_percent_max[core] = load;
+    }
+  }
+}
+
+static void sample_stacks(sys_monitor_sample_t *sample) {
+  for (uint32_t i = 0; i < SYS_MONITOR_TASK_COUNT; i++) {
+    sys_monitor_stack_t *stack = &sample->stacks[i];
+    stack->name = task_names[i];
+    stack->size = task_stack_sizes[i];
+    // tasks never exit once started, so the handle is looked up only once
+    if (task_handles[i] == NULL) {
+      task_handles[i] = xTaskGetHandle(task_names[i]);
+    }
+    stack->running = task_handles[i] != NULL;
+    // in bytes on ESP-IDF, and already the minimum since the task started
+    stack->free_min = stack->running ? uxTaskGetStackHighWaterMark(task_handles[i]) : 0;
+  }
+}
+
+static void sample_memory(sys_monitor_sample_t *sample) {
+  sample->internal_free = heap_caps_get_free_size(MALLOC_CAP_INTERNAL);
+  sample->internal_free_min = heap_caps_get_minimum_free_size(MALLOC_CAP_INTERNAL);
+  sample->internal_largest = heap_caps_get_largest_free_block(MALLOC_CAP_INTERNAL);
+  sample->psram_free = heap_caps_get_free_size(MALLOC_CAP_SPIRAM);
+  sample->psram_free_min = heap_caps_get_minimum_free_size(MALLOC_CAP_SPIRAM);
+  sample->psram_largest = heap_caps_get_largest_free_block(MALLOC_CAP_SPIRAM);
+}
+
+static void sample_queue(sys_monitor_sample_t *sample) {
+  log_pipeline_stats_t pipeline;
+  log_pipeline_get_stats(&pipeline);
+
+  sample->queue_size = MESSAGE_QUEUE_SIZE;
+  sample->queue_used = uxQueueMessagesWaiting(message_queue);
+  if (!sampled || sample->queue_used < sample->queue_min) {
+    sample->queue_min = sample->queue_used;
+  }
+  sample->queue_max = pipeline.queue_peak;
+  sample->dropped = pipeline.dropped;
+}
+
+static FILE *open_csv(void) {
+  char path[64];
+  if (!storage_new_path(SYS_MONITOR_FILE_FMT, SYS_MONITOR_MAX_FILES, path, sizeof(path))) {
+    ESP_LOGE(TAG, "No room for a new CSV file");
+    return NULL;
+  }
+
+  FILE *f = fopen(path, "w");
+  if (f == NULL) {
+    ESP_LOGE(TAG, "Cannot create %s", path);
+    return NULL;
+  }
+
+  fprintf(f, "time_us");
+  for (uint32_t core = 0; core < portNUM_PROCESSORS && core < SYS_MONITOR_MAX_CORES; core++) {
+    fprintf(f, ",cpu%lu", (unsigned long)core);
+  }
+  for (uint32_t i = 0; i < SYS_MONITOR_TASK_COUNT; i++) {
+    fprintf(f, ",%s_stack_free", task_names[i]);
+  }
+  fprintf(f, ",internal_free,internal_free_min,internal_largest,psram_free,psram_free_min,psram_largest,queue_used,queue_max,dropped,"
+             "overrun,parity,framing,break,latency_avg_us,latency_max_us\n");
+
+  ESP_LOGI(TAG, "Writing samples to %s", path);
+  return f;
+}
+
+static void write_csv(const sys_monitor_sample_t *sample) {
+  fprintf(csv_file, "%lld", (long long)sample->time_us);
+  for (uint8_t core = 0; core < sample->cores; core++) {
+    fprintf(csv_file, ",%u", sample->cpu_percent[core]);
+  }
+  for (uint32_t i = 0; i < SYS_MONITOR_TASK_COUNT; i++) {
+    fprintf(csv_file, ",%lu", (unsigned long)sample->stacks[i].free_min);
+  }
+  fprintf(csv_file, ",%zu,%zu,%zu,%zu,%zu,%zu,%lu,%lu,%lu", sample->internal_free, sample->internal_free_min, sample->internal_largest, sample->psram_free,
+          sample->psram_free_min, sample->psram_largest, (unsigned long)sample->queue_used, (unsigned long)sample->queue_max, (unsigned long)sample->dropped);
+  fprintf(csv_file, ",%lu,%lu,%lu,%lu,%lu,%lu\n", (unsigned long)sample->line_errors.overrun, (unsigned long)sample->line_errors.parity,
+          (unsigned long)sample->line_errors.framing, (unsigned long)sample->line_errors.breaks, (unsigned long)sample->latency_avg_us,
+          (unsigned long)sample->latency_max_us);
+  // a session that ends in a crash is the one worth keeping
+  fflush(csv_file);
+}
+
+static void sys_monitor_task(void *arg) {
+  static sys_monitor_sample_t sample;
+  TickType_t last_wake = xTaskGetTickCount();
+
+  last_sample_us = esp_timer_get_time();
+  for (uint8_t core = 0; core < portNUM_PROCESSORS && core < SYS_MONITOR_MAX_CORES; core++) {
+    last_idle_time[core] = ulTaskGetRunTimeCounter(xTaskGetIdleTaskHandleForCore(core));
+  }
+
+  while (1) {
+    vTaskDelayUntil(&last_wake, pdMS_TO_TICKS(SYS_MONITOR_PERIOD_MS));
+
+    int64_t now = esp_timer_get_time();
+    sample.time_us = now;
+    sample_cpu(&sample, now);
+    sample_stacks(&sample);
+    sample_memory(&sample);
+    sample_queue(&sample);
+
+    usb_task_get_line_errors(&sample.line_errors);
+
+    ui_task_stats_t ui;
+    ui_task_get_stats(&ui);
+    sample.latency_avg_us = ui.latency_avg_us;
+    sample.latency_max_us = ui.latency_max_us;
+    last_sample_us = now;
+
+    xSemaphoreTake(sample_mutex, portMAX_DELAY);
+    latest = sample;
+    sampled = true;
+    xSemaphoreGive(sample_mutex);
+
+    if (csv_file != NULL) {
+      write_csv(&sample);
+    }
+  }
+
+  vTaskDelete(NULL);
+}
+
+void sys_monitor_start(void *queue, bool export_csv) {
+  message_queue = (QueueHandle_t)queue;
+  sample_mutex = xSemaphoreCreateMutex();
+  assert(sample_mutex != NULL);
+
+  if (export_csv) {
+    csv_file = open_csv();
+  }
+
+  BaseType_t monitor_task_created = xTaskCreate(sys_monitor_task, "sys_monitor", SYS_MONITOR_STACK_SIZE, NULL, tskIDLE_PRIORITY + 1, NULL);
+  assert(monitor_task_created == pdTRUE);
+}
+
+bool sys_monitor_running(void) { return sample_mutex != NULL; }
+
+bool sys_monitor_get_sample(sys_monitor_sample_t *sample) {
+  if (sample_mutex == NULL) {
+    return false;
+  }
+  xSemaphoreTake(sample_mutex, portMAX_DELAY);
+  bool valid = sampled;
+  *sample = latest;
+  xSemaphoreGive(sample_mutex);
+  return valid;
+}
@@ -0,0 +1,95 @@
+/*
+ * SPDX-FileCopyrightText: 2022-2024 Espressif Systems (Shanghai) CO LTD
+ *
+ * SPDX-License-Identifier: CC0-1.0
+ */
+
+#ifndef SYS_MONITOR_H
+#define SYS_MONITOR_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#include "vcp_rx.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define SYS_MONITOR_MAX_CORES (2)
+// usb_task, usb_lib, ui_task, sys_monitor
+#define SYS_MONITOR_TASK_COUNT (4)
+#define SYS_MONITOR_STACK_SIZE (3072)
+// CSV files are numbered per boot: sysmon_000.csv, sysmon_001.csv, ...
+#define SYS_MONITOR_FILE_FMT "sysmon_%03u.csv"
+#define SYS_MONITOR_MAX_FILES (1000)
+
+/**
+ * @brief Stack usage of one monitored task
+ */
+typedef struct {
+  const char *name;    /*!< FreeRTOS task name */
+  uint32_t size;       /*!< Stack size the task was created with, bytes */
+  uint32_t free_min;   /*!< Stack high-water mark, bytes never used */
+  bool running;        /*!< false until the task has been created */
+} sys_monitor_stack_t;
+
+/**
+ * @brief One resource sample
+ *
+ * Fields named *_min and *_max hold the extreme since boot, the others the
+ * value at the time of the sample.
+ */
+typedef struct {
+  int64_t time_us;                                /*!< esp_timer time of the sample */
+  uint8_t cores;                                  /*!< Number of valid cpu entries */
+  uint8_t cpu_percent[SYS_MONITOR_MAX_CORES];     /*!< Load over the last period */
+  uint8_t cpu_percent_max[SYS_MONITOR_MAX_CORES]; /*!< Highest load of any period */
+  sys_monitor_stack_t stacks[SYS_MONITOR_TASK_COUNT];
+  size_t internal_free;     /*!< Free internal RAM, bytes */
+  size_t internal_free_min; /*!< Lowest free internal RAM */
+  size_t internal_largest;  /*!< Largest free internal block */
+  size_t psram_free;        /*!< Free PSRAM, bytes */
+  size_t psram_free_min;    /*!< Lowest free PSRAM */
+  size_t psram_largest;     /*!< Largest free PSRAM block */
+  uint32_t queue_used;      /*!< Message queue fill level */
+  uint32_t queue_min;       /*!< Lowest sampled fill level */
+  uint32_t queue_max;       /*!< Highest fill level, including bursts between samples */
+  uint32_t queue_size;      /*!< Message queue capacity */
+  uint32_t dropped;         /*!< Messages lost because the queue was full */
+  vcp_line_errors_t line_errors; /*!< UART errors of the current USB adapter */
+  uint32_t latency_avg_us;  /*!< UI render latency, see ui_task.h */
+  uint32_t latency_max_us;
+} sys_monitor_sample_t;
+
+/**
+ * @brief Start sampling resource usage
+ *
+ * A low priority task samples stack high-water marks, per core load, heap,
+ * the message queue and the adapter's line errors every SYS_MONITOR_PERIOD_MS.
+ * Per core load needs CONFIG_FREERTOS_GENERATE_RUN_TIME_STATS.
+ *
+ * @param message_queue Queue of message_t between the pipeline and the UI
+ * @param export_csv Append every sample to a new SYS_MONITOR_FILE_FMT file,
+ *                   timestamps use the same clock as raw captures
+ */
+void sys_monitor_start(void *message_queue, bool export_csv);
+
+/**
+ * @brief True once sys_monitor_start() was called
+ */
+bool sys_monitor_running(void);
+
+/**
+ * @brief Get the latest sample
+ *
+ * @return false if the monitor is not running or has not sampled yet
+ */
+bool sys_monitor_get_sample(sys_monitor_sample_t *sample);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // SYS_MONITOR_H
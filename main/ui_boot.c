@@ -0,0 +1,215 @@
+/*
+ * SPDX-FileCopyrightText: 2022-2024 Espressif Systems (Shanghai) CO LTD
+ *
+ * SPDX-License-Identifier: CC0-1.0
+ */
+
+#include <stdio.h>
+
+#include "lvgl.h"
+
+#include "boot_timeline.h"
+#include "log_pipeline.h"
+#include "storage.h"
+#include "ui_boot.h"
+
+#define UI_BOOT_REFRESH_MS (500)
+#define UI_BOOT_LABEL_WIDTH (180)
+#define UI_BOOT_BAR_HEIGHT (28)
+
+typedef enum {
+  COL_PHASE,
+  COL_DURATION,
+  COL_DELTA,
+  COL_COUNT,
+} boot_col_t;
+
+static const char *const col_names[COL_COUNT] = {"Phase", "ms", "vs previous"};
+static const int32_t col_widths[COL_COUNT] = {300, 160, 180};
+
+static lv_obj_t *bars = NULL;
+static lv_obj_t *table = NULL;
+static lv_obj_t *status = NULL;
+// copied from the pipeline, the view only redraws when the generation changes
+static boot_timeline_t timeline;
+static uint32_t shown_generation = UINT32_MAX;
+
+static lv_color_t phase_color(size_t milestone) { return lv_palette_main((lv_palette_t)(milestone % LV_PALETTE_LAST)); }
+
+static void format_ms(char *out, size_t size, int64_t us, bool sign) {
+  if (us < 0 && !sign) {
+    snprintf(out, size, "-");
+    return;
+  }
+  int64_t magnitude = us < 0 ? -us : us;
+  snprintf(out, size, "%s%lld.%lld", us < 0 ? "-" : (sign ? "+" : ""), (long long)(magnitude / 1000), (long long)(magnitude / 100 % 10));
+}
+
+static void draw_bars(void) {
+  lv_obj_clean(bars);
+  lv_obj_update_layout(bars);
+  int32_t width = lv_obj_get_content_width(bars) - UI_BOOT_LABEL_WIDTH;
+
+  // common scale so a slower boot is visibly longer
+  int64_t longest = 1;
+  for (uint32_t age = 0; age < BOOT_TIMELINE_HISTORY; age++) {
+    const boot_run_t *run = boot_timeline_run(&timeline, age);
+    if (run != NULL && boot_timeline_total_us(&timeline, run) > longest) {
+      longest = boot_timeline_total_us(&timeline, run);
+    }
+  }
+
+  for (uint32_t age = 0; age < BOOT_TIMELINE_HISTORY; age++) {
+    const boot_run_t *run = boot_timeline_run(&timeline, age);
+    if (run == NULL) {
+      break;
+    }
+
+    lv_obj_t *row = lv_obj_create(bars);
+    lv_obj_remove_style_all(row);
+    lv_obj_set_size(row, LV_PCT(100), UI_BOOT_BAR_HEIGHT);
+
+    char total[16];
+    format_ms(total, sizeof(total), boot_timeline_total_us(&timeline, run), false);
+    lv_obj_t *label = lv_label_create(row);
+    lv_label_set_text_fmt(label, "#%lu  %s ms", (unsigned long)run->number, total);
+    lv_obj_align(label, LV_ALIGN_LEFT_MID, 0, 0);
+
+    // bars start at the first milestone reached, not at the boot start
+    int64_t origin = -1;
+    for (size_t i = 0; i < timeline.count; i++) {
+      if (run->at_us[i] < 0) {
+        continue;
+      }
+      if (origin < 0) {
+        origin = run->at_us[i];
+      }
+      int64_t phase = boot_timeline_phase_us(&timeline, run, i);
+      if (phase <= 0) {
+        continue;
+      }
+
+      lv_obj_t *bar = lv_obj_create(row);
+      lv_obj_remove_style_all(bar);
+      lv_obj_set_style_bg_opa(bar, LV_OPA_COVER, 0);
+      lv_obj_set_style_bg_color(bar, phase_color(i), 0);
+      lv_obj_set_pos(bar, UI_BOOT_LABEL_WIDTH + (int32_t)((run->at_us[i] - origin) * width / longest), 2);
+      lv_obj_set_size(bar, LV_MAX(1, (int32_t)(phase * width / longest)), UI_BOOT_BAR_HEIGHT - 4);
+
+      lv_obj_t *name = lv_label_create(bar);
+      lv_label_set_text(name, timeline.milestones[i].name);
+      lv_label_set_long_mode(name, LV_LABEL_LONG_CLIP);
+      lv_obj_set_width(name, LV_PCT(100));
+      lv_obj_set_style_text_color(name, lv_color_white(), 0);
+      lv_obj_center(name);
+    }
+  }
+}
+
+static void fill_table(void) {
+  const boot_run_t *run = boot_timeline_run(&timeline, 0);
+  const boot_run_t *previous = boot_timeline_run(&timeline, 1);
+
+  lv_table_set_row_count(table, 1);
+  for (uint32_t col = 0; col < COL_COUNT; col++) {
+    lv_table_set_cell_value(table, 0, col, col_names[col]);
+  }
+  if (run == NULL) {
+    return;
+  }
+
+  uint32_t r = 1;
+  char text[24];
+  for (size_t i = 0; i < timeline.count; i++) {
+    if (run->at_us[i] < 0) {
+      continue;
+    }
+    int64_t phase = boot_timeline_phase_us(&timeline, run, i);
+    lv_table_set_cell_value(table, r, COL_PHASE, timeline.milestones[i].name);
+    format_ms(text, sizeof(text), phase, false);
+    lv_table_set_cell_value(table, r, COL_DURATION, text);
+    int64_t before = previous != NULL ? boot_timeline_phase_us(&timeline, previous, i) : -1;
+    if (phase >= 0 && before >= 0) {
+      format_ms(text, sizeof(text), phase - before, true);
+    } else {
+      snprintf(text, sizeof(text), "-");
+    }
+    lv_table_set_cell_value(table, r, COL_DELTA, text);
+    r++;
+  }
+
+  int64_t total = boot_timeline_total_us(&timeline, run);
+  lv_table_set_cell_value(table, r, COL_PHASE, "Total");
+  format_ms(text, sizeof(text), total, false);
+  lv_table_set_cell_value(table, r, COL_DURATION, text);
+  if (previous != NULL) {
+    format_ms(text, sizeof(text), total - boot_timeline_total_us(&timeline, previous), true);
+  } else {
+    snprintf(text, sizeof(text), "-");
+  }
+  lv_table_set_cell_value(table, r, COL_DELTA, text);
+}
+
+static void refresh_timer_cb(lv_timer_t *timer) {
+  // boots are rare, skip the copy's redraw unless something changed
+  if (!lv_obj_is_visible(table)) {
+    return;
+  }
+  log_pipeline_get_boot_timeline(&timeline);
+  if (timeline.generation == shown_generation) {
+    return;
+  }
+  shown_generation = timeline.generation;
+  draw_bars();
+  fill_table();
+}
+
+static void export_clicked_cb(lv_event_t *e) {
+  char path[64];
+  if (!storage_new_path(UI_BOOT_TRACE_FMT, UI_BOOT_TRACE_MAX_FILES, path, sizeof(path))) {
+    lv_label_set_text(status, "No storage");
+    return;
+  }
+  FILE *f = fopen(path, "w");
+  if (f == NULL) {
+    lv_label_set_text_fmt(status, "Cannot create %s", path);
+    return;
+  }
+  log_pipeline_get_boot_timeline(&timeline);
+  size_t events = boot_timeline_write_trace(&timeline, f);
+  fclose(f);
+  lv_label_set_text_fmt(status, "%u events written to %s", (unsigned)events, path);
+}
+
+void ui_boot_create(lv_obj_t *parent) {
+  lv_obj_set_flex_flow(parent, LV_FLEX_FLOW_COLUMN);
+
+  lv_obj_t *toolbar = lv_obj_create(parent);
+  lv_obj_remove_style_all(toolbar);
+  lv_obj_set_size(toolbar, LV_PCT(100), LV_SIZE_CONTENT);
+  lv_obj_set_flex_flow(toolbar, LV_FLEX_FLOW_ROW);
+  lv_obj_set_flex_align(toolbar, LV_FLEX_ALIGN_START, LV_FLEX_ALIGN_CENTER, LV_FLEX_ALIGN_CENTER);
+  lv_obj_set_style_pad_column(toolbar, 16, 0);
+
+  lv_obj_t *export_btn = lv_button_create(toolbar);
+  lv_obj_t *export_lbl = lv_label_create(export_btn);
+  lv_label_set_text(export_lbl, "Export trace");
+  lv_obj_add_event_cb(export_btn, export_clicked_cb, LV_EVENT_CLICKED, NULL);
+  status = lv_label_create(toolbar);
+  lv_label_set_text(status, "");
+
+  bars = lv_obj_create(parent);
+  lv_obj_set_size(bars, LV_PCT(100), LV_SIZE_CONTENT);
+  lv_obj_set_flex_flow(bars, LV_FLEX_FLOW_COLUMN);
+
+  table = lv_table_create(parent);
+  lv_obj_set_width(table, LV_PCT(100));
+  lv_obj_set_flex_grow(table, 1);
+  lv_table_set_column_count(table, COL_COUNT);
+  for (uint32_t col = 0; col < COL_COUNT; col++) {
+    lv_table_set_column_width(table, col, col_widths[col]);
+  }
+
+  fill_table();
+  lv_timer_create(refresh_timer_cb, UI_BOOT_REFRESH_MS, NULL);
+}
@@ -0,0 +1,37 @@
+/*
+ * SPDX-FileCopyrightText: 2022-2024 Espressif Systems (Shanghai) CO LTD
+ *
+ * SPDX-License-Identifier: CC0-1.0
+ */
+
+#ifndef UI_BOOT_H
+#define UI_BOOT_H
+
+#include "lvgl.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// Trace exports are numbered: boot_000.json, boot_001.json, ...
+#define UI_BOOT_TRACE_FMT "boot_%03u.json"
+#define UI_BOOT_TRACE_MAX_FILES (1000)
+
+/**
+ * @brief Create the boot timeline view
+ *
+ * One bar per recent boot, split into phases and drawn to a common scale,
+ * and a table of the newest boot's phase durations with the change against
+ * the boot before. The export button writes the history as a Chrome trace
+ * to the SD card or the storage partition. Must be called with the display
+ * lock held.
+ *
+ * @param parent Container the view is created in
+ */
+void ui_boot_create(lv_obj_t *parent);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // UI_BOOT_H
@@ -0,0 +1,86 @@
+/*
+ * SPDX-FileCopyrightText: 2022-2024 Espressif Systems (Shanghai) CO LTD
+ *
+ * SPDX-License-Identifier: CC0-1.0
+ */
+
+#include <stdio.h>
+
+#include "lvgl.h"
+
+#include "sys_monitor.h"
+#include "ui_monitor.h"
+
+#define UI_MONITOR_REFRESH_MS (1000)
+
+static lv_obj_t *overlay = NULL;
+static bool expanded = false;
+
+static void refresh(void) {
+  sys_monitor_sample_t s;
+  if (!sys_monitor_get_sample(&s)) {
+    lv_obj_add_flag(overlay, LV_OBJ_FLAG_HIDDEN);
+    return;
+  }
+  lv_obj_remove_flag(overlay, LV_OBJ_FLAG_HIDDEN);
+
+  char text[512];
+  size_t len = 0;
+
+  len += snprintf(text + len, sizeof(text) - len, "CPU");
+  for (uint8_t core = 0; core < s.cores; core++) {
+    len += snprintf(text + len, sizeof(text) - len, " %u%%", s.cpu_percent[core]);
+  }
+  len += snprintf(text + len, sizeof(text) - len, "  RAM %zuk  PSRAM %zuk  Q %lu/%lu", s.internal_free / 1024, s.psram_free / 1024, (unsigned long)s.queue_used,
+                  (unsigned long)s.queue_size);
+  if (!expanded) {
+    lv_label_set_text(overlay, text);
+    return;
+  }
+
+  len += snprintf(text + len, sizeof(text) - len, "\nCPU max");
+  for (uint8_t core = 0; core < s.cores; core++) {
+    len += snprintf(text + len, sizeof(text) - len, " %u%%", s.cpu_percent_max[core]);
+  }
+  len += snprintf(text + len, sizeof(text) - len, "\nRAM min %zuk, largest %zuk", s.internal_free_min / 1024, s.internal_largest / 1024);
+  len += snprintf(text + len, sizeof(text) - len, "\nPSRAM min %zuk, largest %zuk", s.psram_free_min / 1024, s.psram_largest / 1024);
+  len += snprintf(text + len, sizeof(text) - len, "\nQueue min %lu, max %lu, dropped %lu", (unsigned long)s.queue_min, (unsigned long)s.queue_max,
+                  (unsigned long)s.dropped);
+  len += snprintf(text + len, sizeof(text) - len, "\nLine errors OE %lu PE %lu FE %lu BI %lu", (unsigned long)s.line_errors.overrun,
+                  (unsigned long)s.line_errors.parity, (unsigned long)s.line_errors.framing, (unsigned long)s.line_errors.breaks);
+  len += snprintf(text + len, sizeof(text) - len, "\nLatency avg %lu.%lu ms, max %lu.%lu ms", (unsigned long)(s.latency_avg_us / 1000),
+                  (unsigned long)(s.latency_avg_us / 100 % 10), (unsigned long)(s.latency_max_us / 1000), (unsigned long)(s.latency_max_us / 100 % 10));
+  for (uint32_t i = 0; i < SYS_MONITOR_TASK_COUNT && len < sizeof(text); i++) {
+    const sys_monitor_stack_t *stack = &s.stacks[i];
+    if (stack->running) {
+      len += snprintf(text + len, sizeof(text) - len, "\n%s stack %lu/%lu", stack->name, (unsigned long)(stack->size - stack->free_min), (unsigned long)stack->size);
+    }
+  }
+  lv_label_set_text(overlay, text);
+}
+
+static void refresh_timer_cb(lv_timer_t *timer) { refresh(); }
+
+static void overlay_clicked_cb(lv_event_t *e) {
+  expanded = !expanded;
+  refresh();
+}
+
+void ui_monitor_create(void) {
+  if (!sys_monitor_running()) {
+    // no overlay and no refresh timer to wake LVGL every second
+    return;
+  }
+
+  overlay = lv_label_create(lv_layer_top());
+  lv_obj_align(overlay, LV_ALIGN_TOP_RIGHT, -8, 48);
+  lv_obj_set_style_bg_opa(overlay, LV_OPA_70, 0);
+  lv_obj_set_style_bg_color(overlay, lv_color_black(), 0);
+  lv_obj_set_style_text_color(overlay, lv_color_white(), 0);
+  lv_obj_set_style_pad_all(overlay, 4, 0);
+  lv_obj_add_flag(overlay, LV_OBJ_FLAG_CLICKABLE);
+  lv_obj_add_event_cb(overlay, overlay_clicked_cb, LV_EVENT_CLICKED, NULL);
+
+  refresh();
+  lv_timer_create(refresh_timer_cb, UI_MONITOR_REFRESH_MS, NULL);
+}
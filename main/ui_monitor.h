@@ -0,0 +1,30 @@
+/*
+ * SPDX-FileCopyrightText: 2022-2024 Espressif Systems (Shanghai) CO LTD
+ *
+ * SPDX-License-Identifier: CC0-1.0
+ */
+
+#ifndef UI_MONITOR_H
+#define UI_MONITOR_H
+
+#include "lvgl.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @brief Create the resource monitor overlay
+ *
+ * Shows the latest sys_monitor sample in a corner of the top layer, above
+ * every tab. Clicking it switches between a one line summary and the full
+ * list. Creates nothing unless sys_monitor_start() was called before. Must be
+ * called with the display lock held.
+ */
+void ui_monitor_create(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // UI_MONITOR_H
@@ -0,0 +1,127 @@
+/*
+ * SPDX-FileCopyrightText: 2022-2024 Espressif Systems (Shanghai) CO LTD
+ *
+ * SPDX-License-Identifier: CC0-1.0
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "lvgl.h"
+
+#include "log_pipeline.h"
+#include "log_stats.h"
+#include "ui_stats.h"
+
+#define UI_STATS_REFRESH_MS (1000)
+
+typedef enum {
+  COL_TAG,
+  COL_LEVEL,
+  COL_LINES_1S,
+  COL_LINES_WINDOW,
+  COL_BYTES_1S,
+  COL_BYTES_WINDOW,
+  COL_TOTAL,
+  COL_COUNT,
+} stats_col_t;
+
+static const char *const col_names[COL_COUNT] = {"Tag", "Lvl", "lines/s", "lines/s 10s", "B/s", "B/s 10s", "Total"};
+static const int32_t col_widths[COL_COUNT] = {240, 60, 120, 140, 120, 140, 140};
+
+static lv_obj_t *table = NULL;
+static log_stats_row_t rows[LOG_STATS_TABLE_SIZE + 1];
+static stats_col_t sort_col = COL_LINES_1S;
+static bool sort_desc = true;
+
+static int compare_rows(const void *a, const void *b) {
+  const log_stats_row_t *ra = a;
+  const log_stats_row_t *rb = b;
+  int cmp = 0;
+
+  switch (sort_col) {
+  case COL_TAG:
+    cmp = strcmp(ra->tag, rb->tag);
+    break;
+  case COL_LEVEL:
+    cmp = (int)ra->level - (int)rb->level;
+    break;
+  case COL_LINES_1S:
+    cmp = (ra->lines_1s > rb->lines_1s) - (ra->lines_1s < rb->lines_1s);
+    break;
+  case COL_LINES_WINDOW:
+    cmp = (ra->lines_window > rb->lines_window) - (ra->lines_window < rb->lines_window);
+    break;
+  case COL_BYTES_1S:
+    cmp = (ra->bytes_1s > rb->bytes_1s) - (ra->bytes_1s < rb->bytes_1s);
+    break;
+  case COL_BYTES_WINDOW:
+    cmp = (ra->bytes_window > rb->bytes_window) - (ra->bytes_window < rb->bytes_window);
+    break;
+  default:
+    cmp = (ra->total_lines > rb->total_lines) - (ra->total_lines < rb->total_lines);
+    break;
+  }
+  return sort_desc ? -cmp : cmp;
+}
+
+static void refresh(void) {
+  size_t count = log_pipeline_get_tag_stats(rows, sizeof(rows) / sizeof(rows[0]));
+  qsort(rows, count, sizeof(rows[0]), compare_rows);
+
+  lv_table_set_row_count(table, count + 1);
+  for (uint32_t col = 0; col < COL_COUNT; col++) {
+    lv_table_set_cell_value_fmt(table, 0, col, "%s%s", col_names[col], col == sort_col ? (sort_desc ? " v" : " ^") : "");
+  }
+
+  for (size_t i = 0; i < count; i++) {
+    const log_stats_row_t *row = &rows[i];
+    uint32_t r = i + 1;
+    lv_table_set_cell_value(table, r, COL_TAG, row->tag);
+    lv_table_set_cell_value_fmt(table, r, COL_LEVEL, "%c", log_stats_level_char(row->level));
+    lv_table_set_cell_value_fmt(table, r, COL_LINES_1S, "%lu", (unsigned long)row->lines_1s);
+    lv_table_set_cell_value_fmt(table, r, COL_LINES_WINDOW, "%.1f", row->lines_window);
+    lv_table_set_cell_value_fmt(table, r, COL_BYTES_1S, "%lu", (unsigned long)row->bytes_1s);
+    lv_table_set_cell_value_fmt(table, r, COL_BYTES_WINDOW, "%.0f", row->bytes_window);
+    lv_table_set_cell_value_fmt(table, r, COL_TOTAL, "%llu", (unsigned long long)row->total_lines);
+  }
+}
+
+static void refresh_timer_cb(lv_timer_t *timer) {
+  // rendering a hidden table is wasted work
+  if (lv_obj_is_visible(table)) {
+    refresh();
+  }
+}
+
+static void header_clicked_cb(lv_event_t *e) {
+  uint32_t row;
+  uint32_t col;
+  lv_table_get_selected_cell(table, &row, &col);
+  if (row != 0 || col >= COL_COUNT) {
+    return;
+  }
+
+  if (col == sort_col) {
+    sort_desc = !sort_desc;
+  } else {
+    sort_col = col;
+    // names read best A-Z, rates highest first
+    sort_desc = col != COL_TAG;
+  }
+  refresh();
+}
+
+void ui_stats_create(lv_obj_t *parent) {
+  table = lv_table_create(parent);
+  lv_obj_set_size(table, LV_PCT(100), LV_PCT(100));
+  lv_table_set_column_count(table, COL_COUNT);
+  for (uint32_t col = 0; col < COL_COUNT; col++) {
+    lv_table_set_column_width(table, col, col_widths[col]);
+  }
+  lv_obj_add_event_cb(table, header_clicked_cb, LV_EVENT_VALUE_CHANGED, NULL);
+
+  refresh();
+  lv_timer_create(refresh_timer_cb, UI_STATS_REFRESH_MS, NULL);
+}
@@ -0,0 +1,31 @@
+/*
+ * SPDX-FileCopyrightText: 2022-2024 Espressif Systems (Shanghai) CO LTD
+ *
+ * SPDX-License-Identifier: CC0-1.0
+ */
+
+#ifndef UI_STATS_H
+#define UI_STATS_H
+
+#include "lvgl.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @brief Create the per tag and level rate dashboard
+ *
+ * Refreshes itself once per second. Clicking a column header sorts by that
+ * column, clicking it again reverses the order. Must be called with the
+ * display lock held.
+ *
+ * @param parent Container the table is created in
+ */
+void ui_stats_create(lv_obj_t *parent);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // UI_STATS_H
@@ -2,28 +2,226 @@
 #include <string.h>
 
 #include "esp_log.h"
+#include "esp_timer.h"
 #include "freertos/FreeRTOS.h"
+#include "freertos/queue.h"
 #include "freertos/semphr.h"
 #include "freertos/task.h"
+#if CONFIG_PM_ENABLE
+#include "esp_pm.h"
+#endif
 
 #include "bsp/display.h"
 #include "bsp/esp-bsp.h"
 #include "bsp_board_extra.h"
+#include "log_pipeline.h"
 #include "lvgl.h"
 #include "messaging.h"
+#include "ui_boot.h"
+#include "ui_monitor.h"
+#include "ui_stats.h"
+#include "ui_task.h"
+#include "zlog_dict.h"
+
+// Target time from a line arriving in the pipeline to its row being updated
+#define UI_LATENCY_BUDGET_US (20 * 1000)
+// Messages rendered per display lock, LVGL cannot refresh while it is held
+#define UI_BATCH_MAX (16)
+// Stop rendering and dim the backlight after this long without messages
+#define UI_IDLE_TIMEOUT_MS (60 * 1000)
+#define UI_IDLE_BRIGHTNESS (10)
+// LVGL does not read the touch panel while stopped, it is polled this often
+// instead so a touch can bring the display back
+#define UI_IDLE_TOUCH_POLL_MS (100)
+
+static const char *TAG = "UI";
 
 static lv_obj_t *log_container = NULL;
+static ui_task_stats_t render_stats;
+static int64_t last_budget_warning_us = 0;
+static TaskHandle_t ui_task_handle = NULL;
+static esp_timer_handle_t touch_poll_timer = NULL;
+#if CONFIG_PM_ENABLE
+static esp_pm_lock_handle_t pm_lock = NULL;
+#endif
+
+static lv_obj_t *find_row(uint32_t seq) {
+  // repeats almost always hit one of the newest rows
+  uint32_t count = lv_obj_get_child_count(log_container);
+  for (int32_t i = count - 1; i >= 0; i--) {
+    lv_obj_t *row = lv_obj_get_child(log_container, i);
+    if ((uint32_t)(uintptr_t)lv_obj_get_user_data(row) == seq) {
+      return row;
+    }
+  }
+  return NULL;
+}
+
+static void update_repeat(const message_t *msg) {
+  lv_obj_t *row = find_row(msg->seq);
+  if (row == NULL) {
+    // already scrolled out of the view
+    return;
+  }
+
+  // the counter is created on the first repeat so unique rows stay a single
+  // object
+  lv_obj_t *counter = lv_obj_get_child(row, 0);
+  if (counter == NULL) {
+    counter = lv_label_create(row);
+    lv_obj_align(counter, LV_ALIGN_TOP_RIGHT, 0, 0);
+    lv_obj_set_style_bg_opa(counter, LV_OPA_COVER, 0);
+    lv_obj_set_style_bg_color(counter, lv_palette_lighten(LV_PALETTE_GREY, 3), 0);
+  }
+  lv_label_set_text_fmt(counter, "x%lu  %lu.%03lu-%lu.%03lu s", (unsigned long)msg->repeat, (unsigned long)(msg->first_us / 1000000), (unsigned long)(msg->first_us / 1000 % 1000),
+                        (unsigned long)(msg->last_us / 1000000), (unsigned long)(msg->last_us / 1000 % 1000));
+}
 
 static void lv_hello_world(void) {
   /* Create a screen object */
   lv_obj_t *screen = lv_obj_create(NULL);
 
-  log_container = lv_obj_create(screen);
+  lv_obj_t *tabview = lv_tabview_create(screen);
+  lv_tabview_set_tab_bar_size(tabview, 40);
+  lv_obj_t *log_tab = lv_tabview_add_tab(tabview, "Log");
+  lv_obj_t *stats_tab = lv_tabview_add_tab(tabview, "Stats");
+  lv_obj_t *boot_tab = lv_tabview_add_tab(tabview, "Boot");
+  lv_obj_set_style_pad_all(log_tab, 0, 0);
+  lv_obj_set_style_pad_all(stats_tab, 0, 0);
+
+  log_container = lv_obj_create(log_tab);
   lv_obj_set_size(log_container, LV_PCT(100), LV_PCT(100));
   lv_obj_set_flex_flow(log_container, LV_FLEX_FLOW_COLUMN);
 
+  ui_stats_create(stats_tab);
+  ui_boot_create(boot_tab);
+
   /* Load the screen */
   lv_scr_load(screen);
+
+  ui_monitor_create();
+}
+
+static void render_message(const message_t *msg) {
+  if (msg->kind == MESSAGE_KIND_REPEAT) {
+    update_repeat(msg);
+    return;
+  }
+
+  if (msg->kind == MESSAGE_KIND_REPLACE) {
+    lv_obj_t *row = find_row(msg->seq);
+    if (row != NULL) {
+      lv_label_set_text(row, msg->data);
+    }
+    return;
+  }
+
+  uint32_t logs = lv_obj_get_child_count(log_container);
+  lv_obj_t *log_lbl = lv_label_create(log_container);
+  lv_obj_set_width(log_lbl, LV_PCT(100));
+  lv_obj_set_height(log_lbl, LV_SIZE_CONTENT);
+  if (msg->format == MESSAGE_FORMAT_ZLOG) {
+    // dictionary records are only formatted once they get a row
+    static char text[MAX_MESSAGE_LEN * 2];
+    zlog_dict_format_message(msg, text, sizeof(text));
+    lv_label_set_text(log_lbl, text);
+  } else {
+    lv_label_set_text(log_lbl, msg->data);
+  }
+  lv_obj_set_user_data(log_lbl, (void *)(uintptr_t)msg->seq);
+  if (logs >= MAX_LOG_ROWS) {
+    lv_obj_t *first_child = lv_obj_get_child(log_container, 0);
+    lv_obj_del(first_child);
+  }
+  lv_obj_scroll_to_view(log_lbl, LV_ANIM_OFF);
+}
+
+static void account_latency(const message_t *msg, int64_t now) {
+  // repeat counters are deliberately held back by the pipeline, only new
+  // and updated text counts against the budget
+  if (msg->kind == MESSAGE_KIND_REPEAT) {
+    return;
+  }
+
+  uint32_t latency = (uint32_t)(now - msg->last_us);
+  render_stats.latency_last_us = latency;
+  if (latency > render_stats.latency_max_us) {
+    render_stats.latency_max_us = latency;
+  }
+  render_stats.latency_avg_us += ((int32_t)latency - (int32_t)render_stats.latency_avg_us) / 8;
+  if (latency > UI_LATENCY_BUDGET_US) {
+    render_stats.over_budget++;
+    if (now - last_budget_warning_us >= 1000 * 1000) {
+      last_budget_warning_us = now;
+      ESP_LOGW(TAG, "Render latency %lu us over budget (%lu rows so far)", (unsigned long)latency, (unsigned long)render_stats.over_budget);
+    }
+  }
+}
+
+static void drain_queue(QueueHandle_t message_queue) {
+  static message_t msg;
+  static message_t next;
+
+  bool more = true;
+  while (more) {
+    bsp_display_lock(0);
+    for (uint32_t i = 0; i < UI_BATCH_MAX; i++) {
+      if (xQueueReceive(message_queue, &msg, 0) != pdTRUE) {
+        more = false;
+        break;
+      }
+      // Only the latest of back-to-back in-place updates is visible, skip
+      // the rest so a fast progress bar costs a single row redraw
+      while (msg.kind == MESSAGE_KIND_REPLACE && xQueuePeek(message_queue, &next, 0) == pdTRUE && next.kind == MESSAGE_KIND_REPLACE) {
+        xQueueReceive(message_queue, &msg, 0);
+      }
+      render_message(&msg);
+      account_latency(&msg, esp_timer_get_time());
+    }
+    bsp_display_unlock();
+    render_stats.batches++;
+  }
+}
+
+static void touch_poll_cb(void *arg) { xTaskNotifyGive(ui_task_handle); }
+
+static bool touch_pressed(void) {
+  lv_indev_t *indev = bsp_display_get_input_dev();
+  if (indev == NULL) {
+    return false;
+  }
+
+  bsp_display_lock(0);
+  lv_indev_read(indev);
+  bool pressed = lv_indev_get_state(indev) == LV_INDEV_STATE_PRESSED;
+  if (pressed) {
+    // the touch only wakes the display, it must not also click a widget
+    lv_indev_wait_release(indev);
+  }
+  bsp_display_unlock();
+  return pressed;
+}
+
+static void enter_idle(void) {
+  ESP_LOGI(TAG, "Link idle, display dimmed");
+  bsp_display_brightness_set(UI_IDLE_BRIGHTNESS);
+  // also stops the LVGL tick timer, only the touch poll is left running
+  lvgl_port_stop();
+  esp_timer_start_periodic(touch_poll_timer, UI_IDLE_TOUCH_POLL_MS * 1000);
+#if CONFIG_PM_ENABLE
+  esp_pm_lock_release(pm_lock);
+#endif
+  render_stats.idle = true;
+}
+
+static void leave_idle(void) {
+#if CONFIG_PM_ENABLE
+  esp_pm_lock_acquire(pm_lock);
+#endif
+  esp_timer_stop(touch_poll_timer);
+  lvgl_port_resume();
+  bsp_display_backlight_on();
+  render_stats.idle = false;
 }
 
 static void ui_task(void *arg) {
@@ -46,32 +244,61 @@ static void ui_task(void *arg) {
 
   bsp_display_unlock();
 
-  message_t msg;
+#if CONFIG_PM_ENABLE
+  // held while rendering, released when idle so the chip may light sleep
+  ESP_ERROR_CHECK(esp_pm_lock_create(ESP_PM_CPU_FREQ_MAX, 0, "ui", &pm_lock));
+  esp_pm_lock_acquire(pm_lock);
+#endif
+
+  ui_task_handle = xTaskGetCurrentTaskHandle();
+  const esp_timer_create_args_t timer_args = {
+      .callback = touch_poll_cb,
+      .name = "ui_touch",
+  };
+  ESP_ERROR_CHECK(esp_timer_create(&timer_args, &touch_poll_timer));
+
+  log_pipeline_set_consumer(ui_task_handle);
+  int64_t last_activity_us = esp_timer_get_time();
 
   while (1) {
-    // Wait for a message from the queue
-    if (xQueueReceive(message_queue, &msg, pdMS_TO_TICKS(100)) == pdTRUE) {
-      uint32_t logs = lv_obj_get_child_count(log_container);
-
-      bsp_display_lock(0);
-      lv_obj_t *log_lbl = lv_label_create(log_container);
-      lv_obj_set_width(log_lbl, LV_PCT(100));
-      lv_obj_set_height(log_lbl, LV_SIZE_CONTENT);
-      lv_label_set_text(log_lbl, msg.data);
-      if (logs > 50) {
-        lv_obj_t *first_child = lv_obj_get_child(log_container, 0);
-        lv_obj_del(first_child);
+    // Sleep until the pipeline queues something. While active, also wake
+    // once when the idle timeout expires; once idle, wake only for the
+    // touch poll.
+    if (uxQueueMessagesWaiting(message_queue) == 0) {
+      TickType_t wait = portMAX_DELAY;
+      if (!render_stats.idle) {
+        int64_t left_ms = UI_IDLE_TIMEOUT_MS - (esp_timer_get_time() - last_activity_us) / 1000;
+        wait = left_ms > 0 ? pdMS_TO_TICKS(left_ms) : 0;
+      }
+      ulTaskNotifyTake(pdTRUE, wait);
+    }
+
+    if (uxQueueMessagesWaiting(message_queue) == 0) {
+      if (render_stats.idle) {
+        if (touch_pressed()) {
+          leave_idle();
+          last_activity_us = esp_timer_get_time();
+        }
+      } else if (esp_timer_get_time() - last_activity_us >= UI_IDLE_TIMEOUT_MS * 1000LL) {
+        enter_idle();
       }
-      lv_obj_scroll_to_view(log_lbl, LV_ANIM_OFF);
-      bsp_display_unlock();
+      continue;
     }
+
+    if (render_stats.idle) {
+      leave_idle();
+    }
+    drain_queue(message_queue);
+    last_activity_us = esp_timer_get_time();
   }
 
   vTaskDelete(NULL);
 }
 
+void ui_task_get_stats(ui_task_stats_t *stats) { *stats = render_stats; }
+
 void ui_task_start(void *message_queue) {
   BaseType_t ui_task_created = xTaskCreatePinnedToCore(
-      ui_task, "ui_task", 4096, message_queue, tskIDLE_PRIORITY + 2, NULL, 0);
+      ui_task, "ui_task", UI_TASK_STACK_SIZE, message_queue, tskIDLE_PRIORITY + 2, NULL, 0);
   assert(ui_task_created == pdTRUE);
 }
\ No newline at end of file
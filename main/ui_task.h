@@ -7,15 +7,48 @@
 #ifndef UI_TASK_H
 #define UI_TASK_H
 
-#include <stdint.h>
+#include <stdbool.h>
 #include <stddef.h>
+#include <stdint.h>
 
 #ifdef __cplusplus
 extern "C" {
 #endif
 
+// Stack size in bytes, peak usage is measured at runtime by sys_monitor
+#define UI_TASK_STACK_SIZE (4096)
+
+/**
+ * @brief Render statistics of the UI task
+ *
+ * Latency is measured from the moment the pipeline framed a line to the
+ * moment its row was updated; the panel refresh adds up to one LVGL refresh
+ * period on top.
+ */
+typedef struct {
+  uint32_t latency_last_us; /*!< Latency of the last rendered line */
+  uint32_t latency_avg_us;  /*!< Moving average latency */
+  uint32_t latency_max_us;  /*!< Worst latency since start */
+  uint32_t over_budget;     /*!< Lines rendered later than the budget */
+  uint32_t batches;         /*!< Display lock acquisitions for rendering */
+  bool idle;                /*!< Rendering stopped and backlight dimmed */
+} ui_task_stats_t;
+
+/**
+ * @brief Start the UI task
+ *
+ * The task sleeps until the log pipeline notifies it, renders everything
+ * queued in batches and dims the display after a period without data.
+ *
+ * @param message_queue Queue of message_t filled by the log pipeline
+ */
 void ui_task_start(void *message_queue);
 
+/**
+ * @brief Get a snapshot of the UI render statistics
+ */
+void ui_task_get_stats(ui_task_stats_t *stats);
+
 #ifdef __cplusplus
 }
 #endif
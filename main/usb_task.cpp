@@ -15,7 +15,9 @@
 #include "usb/usb_host.h"
 
 #include "usb_task.h"
-#include "messaging.h"
+#include "log_pipeline.h"
+#include "raw_capture.h"
+#include "vcp_rx.h"
 
 using namespace esp_usb;
 
@@ -24,88 +26,48 @@ using namespace esp_usb;
 #define EXAMPLE_PARITY              (0)      // 0: None, 1: Odd, 2: Even, 3: Mark, 4: Space
 #define EXAMPLE_DATA_BITS           (8)
 #define UART_INPUT_BUFFER_SIZE      (256)
-
-char line_buffer[UART_INPUT_BUFFER_SIZE];
+#define EXAMPLE_MAX_PACKET_SIZE     (0)      // Bulk IN max packet size, 0: derive from the driver and PID
 
 namespace {
 static const char *TAG = "VCP example";
 static SemaphoreHandle_t device_disconnected_sem;
+static vcp_rx_t vcp_rx;
 
-bool exclude_ftdi_ansisgr_newlines(uint8_t in) {
-  static bool ftdi_frame_started = false;
-  static bool ansi_sgr_started = false;
-  static bool new_line_started = false;
-  // ftdi
-  if (in == 0x01) {
-    ftdi_frame_started = true;
-    return true;
-  }
-
-  if (ftdi_frame_started && (in == 0x60 || in == 0x62)) {
-    ftdi_frame_started = false;
-    return true;
-  }
-
-  // ansi-sgr
-  if (in == 0x1b) {
-    ansi_sgr_started = true;
-    return true;
-  }
-
-  if (ansi_sgr_started && in == 0x6d) {
-    ansi_sgr_started = false;
-    return true;
-  }
-
-  if (ansi_sgr_started) {
-    // any byte inside the sgr
-    return true;
-  }
-
-  // new line
-  if (in == 0x0d) {
-    new_line_started = true;
-    return true;
-  }
-
-  if (new_line_started && in == 0x0a) {
-    new_line_started = false;
-    return true;
-  }
+static void feed_pipeline(const uint8_t *data, size_t len, void *ctx)
+{
+    log_pipeline_feed(data, len);
+}
 
-  return false;
+// Called with the driver VCP::open() picked, before that driver opens the
+// device and its first IN transfer can complete
+static void on_driver_selected(vcp_driver_t driver, uint16_t pid)
+{
+    uint16_t max_packet = EXAMPLE_MAX_PACKET_SIZE ? EXAMPLE_MAX_PACKET_SIZE : vcp_rx_default_max_packet(driver, pid);
+    ESP_LOGI(TAG, "Driver %d, PID 0x%04X, max packet %u", driver, pid, max_packet);
+    vcp_rx_init(&vcp_rx, driver, max_packet, feed_pipeline, NULL);
+    raw_capture_start(driver, max_packet);
 }
 
+/**
+ * @brief VCP driver that reports itself when the VCP service constructs it
+ *
+ * VCP::open() only returns a CdcAcmDevice pointer and RTTI is disabled, so
+ * the selected driver is noted from the constructor. The comma expression
+ * runs before the base class constructor, i.e. before any data arrives.
+ */
+template <class T, vcp_driver_t Driver>
+class ReportingDriver : public T {
+public:
+    ReportingDriver(uint16_t pid, const cdc_acm_host_device_config_t *dev_config, uint8_t interface_idx = 0)
+        : T((on_driver_selected(Driver, pid), pid), dev_config, interface_idx)
+    {
+    }
+};
+
 static bool handle_rx(const uint8_t *data, size_t data_len, void *arg)
 {
-	static message_t out_message;
-  	QueueHandle_t message_queue = (QueueHandle_t)arg;
-  	if (message_queue != NULL) {
-        for (int i = 0; i < data_len; i++) {
-            uint8_t byte = data[i];
-            bool excluded = exclude_ftdi_ansisgr_newlines(byte);
-            bool flush = false;
-            if (excluded) {
-            if (byte == 0x0a) {
-                flush = true;
-            }
-            } else {
-            out_message.data[out_message.len] = byte;
-            out_message.len++;
-            }
-
-            if (out_message.len == MAX_MESSAGE_LEN -1) {
-                flush = true;
-            }
-
-            if (flush) {
-                printf("%s\n", (char *)out_message.data);
-				xQueueSendToBack(message_queue, &out_message, 0);
-                memset(out_message.data, 0, MAX_MESSAGE_LEN);
-                out_message.len = 0;
-            }
-        }
-    }
+    raw_capture_record(data, data_len);
+    vcp_rx_feed(&vcp_rx, data, data_len);
     return true;
 }
 
@@ -120,9 +82,16 @@ static void handle_event(const cdc_acm_host_dev_event_data_t *event, void *user_
         ESP_LOGI(TAG, "Device suddenly disconnected");
         xSemaphoreGive(device_disconnected_sem);
         break;
-    case CDC_ACM_HOST_SERIAL_STATE:
-        ESP_LOGI(TAG, "Serial state notif 0x%04X", event->data.serial_state.val);
+    case CDC_ACM_HOST_SERIAL_STATE: {
+        // line errors of the first packet of a transfer only arrive here,
+        // and only when they change
+        const cdc_acm_uart_state_t state = event->data.serial_state;
+        uint8_t line_status = (state.bOverRun ? VCP_FTDI_LSR_OE : 0) | (state.bParity ? VCP_FTDI_LSR_PE : 0) |
+                              (state.bFraming ? VCP_FTDI_LSR_FE : 0) | (state.bBreak ? VCP_FTDI_LSR_BI : 0);
+        vcp_rx_count_line_status(&vcp_rx, line_status);
+        ESP_LOGD(TAG, "Serial state notif 0x%04X", event->data.serial_state.val);
         break;
+    }
     case CDC_ACM_HOST_NETWORK_CONNECTION:
     default: break;
     }
@@ -160,16 +129,16 @@ static void usb_task_internal(void *arg)
     ESP_ERROR_CHECK(usb_host_install(&host_config));
 
     // Create a task that will handle USB library events
-    BaseType_t task_created = xTaskCreate(usb_lib_task, "usb_lib", 4096, NULL, 10, NULL);
+    BaseType_t task_created = xTaskCreate(usb_lib_task, "usb_lib", USB_LIB_TASK_STACK_SIZE, NULL, 10, NULL);
     assert(task_created == pdTRUE);
 
     ESP_LOGI(TAG, "Installing CDC-ACM driver");
     ESP_ERROR_CHECK(cdc_acm_host_install(NULL));
 
     // Register VCP drivers to VCP service
-    VCP::register_driver<FT23x>();
-    VCP::register_driver<CP210x>();
-    VCP::register_driver<CH34x>();
+    VCP::register_driver<ReportingDriver<FT23x, VCP_DRIVER_FT23X>>();
+    VCP::register_driver<ReportingDriver<CP210x, VCP_DRIVER_CP210X>>();
+    VCP::register_driver<ReportingDriver<CH34x, VCP_DRIVER_CH34X>>();
 
     // Do everything else in a loop, so we can demonstrate USB device reconnections
     while (true) {
@@ -188,6 +157,8 @@ static void usb_task_internal(void *arg)
 
         if (vcp == nullptr) {
             ESP_LOGI(TAG, "Failed to open VCP device");
+            // the driver may have been selected before opening failed
+            raw_capture_stop();
             continue;
         }
         vTaskDelay(10);
@@ -210,13 +181,21 @@ static void usb_task_internal(void *arg)
         // We are done. Wait for device disconnection and start over
         ESP_LOGI(TAG, "Done. You can reconnect the VCP device to run again.");
         xSemaphoreTake(device_disconnected_sem, portMAX_DELAY);
+        raw_capture_stop();
+        ESP_LOGI(TAG, "Line errors: %lu overrun, %lu parity, %lu framing, %lu break", (unsigned long)vcp_rx.errors.overrun,
+                 (unsigned long)vcp_rx.errors.parity, (unsigned long)vcp_rx.errors.framing, (unsigned long)vcp_rx.errors.breaks);
     }
 }
 } // namespace
 
+void usb_task_get_line_errors(vcp_line_errors_t *errors)
+{
+    *errors = vcp_rx.errors;
+}
+
 void usb_task_start(void *message_queue)
 {
     // Create the USB task
-    BaseType_t app_task_created = xTaskCreate(usb_task_internal, "usb_task", 4096, message_queue, tskIDLE_PRIORITY, NULL);
+    BaseType_t app_task_created = xTaskCreate(usb_task_internal, "usb_task", USB_TASK_STACK_SIZE, message_queue, tskIDLE_PRIORITY, NULL);
     assert(app_task_created == pdTRUE);
 }
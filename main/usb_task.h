@@ -10,10 +10,16 @@
 #include <stdint.h>
 #include <stddef.h>
 
+#include "vcp_rx.h"
+
 #ifdef __cplusplus
 extern "C" {
 #endif
 
+// Stack sizes in bytes, peak usage is measured at runtime by sys_monitor
+#define USB_TASK_STACK_SIZE (4096)
+#define USB_LIB_TASK_STACK_SIZE (4096)
+
 /**
  * @brief Initialize and start the USB task
  *
@@ -24,6 +30,13 @@ extern "C" {
  */
 void usb_task_start(void *message_queue);
 
+/**
+ * @brief Get the UART line errors reported by the current adapter
+ *
+ * Counted since the last connection, see vcp_rx.h.
+ */
+void usb_task_get_line_errors(vcp_line_errors_t *errors);
+
 #ifdef __cplusplus
 }
 #endif
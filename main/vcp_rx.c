@@ -0,0 +1,67 @@
+/*
+ * SPDX-FileCopyrightText: 2022-2024 Espressif Systems (Shanghai) CO LTD
+ *
+ * SPDX-License-Identifier: CC0-1.0
+ */
+
+#include <string.h>
+
+#include "vcp_rx.h"
+
+#define VCP_FULL_SPEED_MAX_PACKET (64)
+#define VCP_HIGH_SPEED_MAX_PACKET (512)
+
+uint16_t vcp_rx_default_max_packet(uint8_t driver, uint16_t pid) {
+  if (driver == VCP_DRIVER_FT23X) {
+    switch (pid) {
+    case 0x6010: // FT2232H
+    case 0x6011: // FT4232H
+    case 0x6014: // FT232H
+      return VCP_HIGH_SPEED_MAX_PACKET;
+    default:
+      break;
+    }
+  }
+  return VCP_FULL_SPEED_MAX_PACKET;
+}
+
+void vcp_rx_init(vcp_rx_t *rx, uint8_t driver, uint16_t max_packet, vcp_rx_sink_t sink, void *ctx) {
+  memset(rx, 0, sizeof(*rx));
+  rx->driver = driver;
+  rx->max_packet = max_packet != 0 ? max_packet : vcp_rx_default_max_packet(driver, 0);
+  if (rx->max_packet <= VCP_FTDI_STATUS_LEN) {
+    rx->max_packet = VCP_FULL_SPEED_MAX_PACKET;
+  }
+  rx->sink = sink;
+  rx->sink_ctx = ctx;
+}
+
+void vcp_rx_count_line_status(vcp_rx_t *rx, uint8_t line_status) {
+  rx->errors.overrun += (line_status & VCP_FTDI_LSR_OE) != 0;
+  rx->errors.parity += (line_status & VCP_FTDI_LSR_PE) != 0;
+  rx->errors.framing += (line_status & VCP_FTDI_LSR_FE) != 0;
+  rx->errors.breaks += (line_status & VCP_FTDI_LSR_BI) != 0;
+}
+
+void vcp_rx_feed(vcp_rx_t *rx, const uint8_t *data, size_t len) {
+  if (rx->driver != VCP_DRIVER_FT23X) {
+    rx->sink(data, len, rx->sink_ctx);
+    return;
+  }
+
+  // the first packet's status is already gone, so its payload is a full
+  // packet minus the status and every further packet starts with a status
+  size_t payload = rx->max_packet - VCP_FTDI_STATUS_LEN;
+  size_t pos = 0;
+  while (pos < len) {
+    size_t n = len - pos < payload ? len - pos : payload;
+    rx->sink(data + pos, n, rx->sink_ctx);
+    pos += n;
+    if (len - pos < VCP_FTDI_STATUS_LEN) {
+      // end of the transfer; a lone byte would be a truncated status
+      break;
+    }
+    vcp_rx_count_line_status(rx, data[pos + 1]);
+    pos += VCP_FTDI_STATUS_LEN;
+  }
+}
@@ -0,0 +1,101 @@
+/*
+ * SPDX-FileCopyrightText: 2022-2024 Espressif Systems (Shanghai) CO LTD
+ *
+ * SPDX-License-Identifier: CC0-1.0
+ */
+
+#ifndef VCP_RX_H
+#define VCP_RX_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @brief VCP driver a device was opened with, stored in raw captures
+ */
+typedef enum {
+  VCP_DRIVER_UNKNOWN = 0, /*!< Data is passed through unchanged */
+  VCP_DRIVER_FT23X = 1,
+  VCP_DRIVER_CP210X = 2,
+  VCP_DRIVER_CH34X = 3,
+} vcp_driver_t;
+
+// Every FTDI bulk IN packet starts with two status bytes: modem status, then
+// line status
+#define VCP_FTDI_STATUS_LEN (2)
+#define VCP_FTDI_LSR_OE (0x02) /*!< Overrun error */
+#define VCP_FTDI_LSR_PE (0x04) /*!< Parity error */
+#define VCP_FTDI_LSR_FE (0x08) /*!< Framing error */
+#define VCP_FTDI_LSR_BI (0x10) /*!< Break interrupt */
+
+/**
+ * @brief UART line errors reported by the adapter
+ */
+typedef struct {
+  uint32_t overrun;
+  uint32_t parity;
+  uint32_t framing;
+  uint32_t breaks;
+} vcp_line_errors_t;
+
+typedef void (*vcp_rx_sink_t)(const uint8_t *data, size_t len, void *ctx);
+
+/**
+ * @brief Removes in-band status from the data delivered by a VCP driver
+ *
+ * The esp-usb FT23x driver strips the status of the first packet of each IN
+ * transfer only. When a transfer spans several max packet sized packets the
+ * status of every following packet is still in the data, at offsets
+ * max_packet * k - 2. CP210x and CH34x have no in-band status. Does not
+ * depend on FreeRTOS so it can be built on the host.
+ */
+typedef struct {
+  uint8_t driver;
+  uint16_t max_packet;
+  vcp_line_errors_t errors;
+  vcp_rx_sink_t sink;
+  void *sink_ctx;
+} vcp_rx_t;
+
+/**
+ * @brief Bulk IN max packet size of a device, from its driver and PID
+ *
+ * High speed FTDI parts (FT232H, FT2232H, FT4232H) use 512 byte packets when
+ * attached to a high speed host, everything else 64.
+ */
+uint16_t vcp_rx_default_max_packet(uint8_t driver, uint16_t pid);
+
+/**
+ * @brief Reset the counters and attach the payload sink
+ *
+ * @param max_packet Bulk IN max packet size, 0 for the driver default
+ */
+void vcp_rx_init(vcp_rx_t *rx, uint8_t driver, uint16_t max_packet, vcp_rx_sink_t sink, void *ctx);
+
+/**
+ * @brief Pass the data of one driver data callback to the sink
+ *
+ * Walks the packet boundaries in a single pass and hands every payload
+ * segment to the sink without copying. Status bytes are decoded into the
+ * line error counters.
+ */
+void vcp_rx_feed(vcp_rx_t *rx, const uint8_t *data, size_t len);
+
+/**
+ * @brief Count the error bits of an FTDI line status byte
+ *
+ * Used for the status of the first packet, which the driver reports through
+ * CDC_ACM_HOST_SERIAL_STATE events instead of the data.
+ */
+void vcp_rx_count_line_status(vcp_rx_t *rx, uint8_t line_status);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // VCP_RX_H
@@ -0,0 +1,461 @@
+/*
+ * SPDX-FileCopyrightText: 2022-2024 Espressif Systems (Shanghai) CO LTD
+ *
+ * SPDX-License-Identifier: CC0-1.0
+ */
+
+#include <stdio.h>
+#include <string.h>
+
+#include "zlog_decoder.h"
+
+#define ZLOG_SYNC_LEN (sizeof(ZLOG_SYNC_MAGIC) - 1)
+// domain/level, package_len and data_len, then the source pointer
+#define ZLOG_NORMAL_HDR_LEN (5 + 4)
+#define ZLOG_DROPPED_HDR_LEN (2)
+
+static uint32_t get_le16(const uint8_t *p) { return p[0] | (p[1] << 8); }
+
+static uint32_t get_le32(const uint8_t *p) { return p[0] | (p[1] << 8) | (p[2] << 16) | ((uint32_t)p[3] << 24); }
+
+static uint64_t get_le64(const uint8_t *p) { return get_le32(p) | ((uint64_t)get_le32(p + 4) << 32); }
+
+static void enter_type(zlog_decoder_t *dec) {
+  dec->state = ZLOG_STATE_TYPE;
+  dec->have = 0;
+  dec->hex_high = -1;
+  dec->pending_len = 0;
+}
+
+static uint8_t next_sync_pos(uint8_t pos, uint8_t byte) {
+  static const char magic[] = ZLOG_SYNC_MAGIC;
+
+  if (magic[pos] == byte) {
+    return pos + 1;
+  }
+  // longest prefix of the magic that is a suffix of what was matched plus
+  // this byte, the magic is short enough to not need a KMP table
+  for (uint8_t k = pos; k > 0; k--) {
+    if (magic[k - 1] == byte && memcmp(magic, magic + pos - k + 1, k - 1) == 0) {
+      return k;
+    }
+  }
+  return 0;
+}
+
+static void deliver(zlog_decoder_t *dec) {
+  size_t stored = dec->package_len < ZLOG_MAX_RECORD ? dec->package_len : ZLOG_MAX_RECORD;
+  if (dec->record_cb != NULL) {
+    dec->record_cb(&dec->record, dec->buf, stored, dec->cb_ctx);
+  }
+  enter_type(dec);
+}
+
+// Returns false if the byte cannot be part of a dictionary record
+static bool process_byte(zlog_decoder_t *dec, uint8_t byte) {
+  switch (dec->state) {
+  case ZLOG_STATE_TYPE:
+    if (byte == ZLOG_MSG_TYPE_NORMAL) {
+      dec->need = ZLOG_NORMAL_HDR_LEN + (dec->timestamp_64 ? 8 : 4);
+    } else if (byte == ZLOG_MSG_TYPE_DROPPED) {
+      dec->need = ZLOG_DROPPED_HDR_LEN;
+    } else {
+      return false;
+    }
+    dec->type = byte;
+    dec->have = 0;
+    dec->state = ZLOG_STATE_HEADER;
+    return true;
+
+  case ZLOG_STATE_HEADER:
+    dec->buf[dec->have++] = byte;
+    if (dec->have < dec->need) {
+      return true;
+    }
+    memset(&dec->record, 0, sizeof(dec->record));
+    if (dec->type == ZLOG_MSG_TYPE_DROPPED) {
+      dec->record.dropped = get_le16(dec->buf);
+      if (dec->record_cb != NULL) {
+        dec->record_cb(&dec->record, NULL, 0, dec->cb_ctx);
+      }
+      enter_type(dec);
+      return true;
+    }
+    dec->record.domain = dec->buf[0] & 0x0f;
+    dec->record.level = dec->buf[0] >> 4;
+    dec->package_len = get_le16(dec->buf + 1);
+    dec->data_len = get_le16(dec->buf + 3);
+    dec->record.source = get_le32(dec->buf + 5);
+    dec->record.timestamp = dec->timestamp_64 ? get_le64(dec->buf + 9) : get_le32(dec->buf + 9);
+    // a package holds at least its header and the format string pointer
+    if (dec->record.level < 1 || dec->record.level > 4 || dec->package_len < 8) {
+      return false;
+    }
+    dec->need = dec->package_len + dec->data_len;
+    dec->have = 0;
+    dec->state = ZLOG_STATE_BODY;
+    // a valid header, the record is no longer given back as text
+    dec->pending_len = 0;
+    return true;
+
+  case ZLOG_STATE_BODY:
+    if (dec->have < ZLOG_MAX_RECORD) {
+      dec->buf[dec->have] = byte;
+    }
+    dec->have++;
+    if (dec->have == dec->need) {
+      deliver(dec);
+    }
+    return true;
+
+  default:
+    return false;
+  }
+}
+
+static int hex_value(uint8_t c) {
+  if (c >= '0' && c <= '9') {
+    return c - '0';
+  }
+  if (c >= 'a' && c <= 'f') {
+    return c - 'a' + 10;
+  }
+  if (c >= 'A' && c <= 'F') {
+    return c - 'A' + 10;
+  }
+  return -1;
+}
+
+void zlog_decoder_init(zlog_decoder_t *dec, bool hex, bool timestamp_64, zlog_record_cb_t record_cb, zlog_text_cb_t text_cb, void *ctx) {
+  memset(dec, 0, sizeof(*dec));
+  dec->state = ZLOG_STATE_TEXT;
+  dec->hex = hex;
+  dec->timestamp_64 = timestamp_64;
+  dec->hex_high = -1;
+  dec->record_cb = record_cb;
+  dec->text_cb = text_cb;
+  dec->cb_ctx = ctx;
+}
+
+void zlog_decoder_set_unsynced(zlog_decoder_t *dec, bool enable) {
+  dec->unsynced = enable && !dec->hex;
+  if (dec->unsynced && dec->state == ZLOG_STATE_TEXT && dec->sync_pos == 0) {
+    enter_type(dec);
+  }
+}
+
+static void emit_text(zlog_decoder_t *dec, const uint8_t *data, size_t len) {
+  if (len > 0 && dec->text_cb != NULL) {
+    dec->text_cb(data, len, dec->cb_ctx);
+  }
+}
+
+void zlog_decoder_feed(zlog_decoder_t *dec, const uint8_t *data, size_t len) {
+  size_t text_start = 0;
+
+  for (size_t i = 0; i < len; i++) {
+    uint8_t byte = data[i];
+
+    if (dec->state == ZLOG_STATE_TEXT) {
+      uint8_t pos = next_sync_pos(dec->sync_pos, byte);
+      // bytes that fell out of a partial match and were held back from an
+      // earlier chunk are text after all
+      size_t released = dec->sync_pos + 1 - pos;
+      if (released > dec->held) {
+        released = dec->held;
+      }
+      emit_text(dec, (const uint8_t *)ZLOG_SYNC_MAGIC, released);
+      dec->held -= released;
+      dec->sync_pos = pos;
+
+      if (dec->sync_pos == ZLOG_SYNC_LEN) {
+        size_t magic_start = i + 1 - (ZLOG_SYNC_LEN - dec->held);
+        emit_text(dec, data + text_start, magic_start - text_start);
+        dec->sync_pos = 0;
+        dec->held = 0;
+        enter_type(dec);
+      } else if (dec->unsynced && byte == '\n') {
+        // the next line may be a record again
+        emit_text(dec, data + text_start, i + 1 - text_start);
+        enter_type(dec);
+      }
+      continue;
+    }
+
+    // keep the raw bytes until the header is known to be valid, so they can
+    // be given back as text
+    bool held = false;
+    if (dec->state != ZLOG_STATE_BODY && dec->pending_len < ZLOG_MAX_PENDING) {
+      dec->pending[dec->pending_len++] = byte;
+      held = true;
+    }
+
+    bool valid;
+    if (dec->hex) {
+      int nibble = hex_value(byte);
+      if (nibble < 0 && (byte == '\r' || byte == '\n' || byte == ' ')) {
+        continue;
+      }
+      if (nibble < 0) {
+        valid = false;
+      } else if (dec->hex_high < 0) {
+        dec->hex_high = nibble;
+        continue;
+      } else {
+        uint8_t value = (dec->hex_high << 4) | nibble;
+        dec->hex_high = -1;
+        valid = process_byte(dec, value);
+      }
+    } else {
+      valid = process_byte(dec, byte);
+    }
+
+    if (!valid) {
+      // not dictionary data (anymore), hand the held bytes and this one on
+      // as text, e.g. the "D" of an MCUboot "D: ..." line in hex mode
+      emit_text(dec, dec->pending, dec->pending_len - (held ? 1 : 0));
+      dec->pending_len = 0;
+      dec->state = ZLOG_STATE_TEXT;
+      dec->sync_pos = next_sync_pos(0, byte);
+      dec->held = 0;
+      text_start = i;
+      if (dec->unsynced && byte == '\n') {
+        // an empty line, the next one may be a record again
+        emit_text(dec, data + i, 1);
+        enter_type(dec);
+      }
+    }
+  }
+
+  if (dec->state == ZLOG_STATE_TEXT) {
+    // hold back a partial match of the magic until the next chunk decides
+    size_t partial = dec->sync_pos - dec->held;
+    emit_text(dec, data + text_start, len - partial - text_start);
+    dec->held = dec->sync_pos;
+  }
+}
+
+bool zlog_decoder_active(const zlog_decoder_t *dec) { return dec->state != ZLOG_STATE_TEXT; }
+
+typedef struct {
+  const uint8_t *package;
+  size_t package_len;
+  size_t offset; /*!< Next argument */
+  const uint8_t *strings; /*!< Strings appended to the package */
+  size_t strings_len;
+  uint8_t string_count;
+} zlog_args_t;
+
+// Strings copied into the package are stored as an argument index (in words)
+// followed by the NUL terminated string
+static const char *appended_string(const zlog_args_t *args, size_t word) {
+  const uint8_t *p = args->strings;
+  const uint8_t *end = args->strings + args->strings_len;
+
+  for (uint8_t i = 0; i < args->string_count && p < end; i++) {
+    uint8_t index = *p++;
+    const uint8_t *nul = memchr(p, '\0', end - p);
+    if (nul == NULL) {
+      return NULL;
+    }
+    if (index == word) {
+      return (const char *)p;
+    }
+    p = nul + 1;
+  }
+  return NULL;
+}
+
+static bool next_arg(zlog_args_t *args, size_t size, uint64_t *value, size_t *word) {
+  // 64-bit arguments are aligned to 8 bytes on 32-bit targets
+  if (size == 8) {
+    args->offset = (args->offset + 7) & ~(size_t)7;
+  }
+  if (args->offset + size > args->package_len) {
+    return false;
+  }
+  *word = args->offset / 4;
+  *value = size == 8 ? get_le64(args->package + args->offset) : get_le32(args->package + args->offset);
+  args->offset += size;
+  return true;
+}
+
+static const char *resolve_string(const zlog_args_t *args, uint32_t addr, size_t word, zlog_string_lookup_t lookup, void *ctx) {
+  const char *str = appended_string(args, word);
+  if (str == NULL && lookup != NULL) {
+    str = lookup(addr, ctx);
+  }
+  return str;
+}
+
+size_t zlog_format(const uint8_t *package, size_t package_len, size_t header_len, zlog_string_lookup_t lookup, void *ctx, char *out, size_t out_size) {
+  size_t pos = 0;
+
+  if (out_size == 0) {
+    return 0;
+  }
+  out[0] = '\0';
+  if (package_len < header_len + 4) {
+    return snprintf(out, out_size, "<short package>");
+  }
+
+  zlog_args_t args = {
+      .package = package,
+      .package_len = package_len,
+      .offset = header_len + 4,
+  };
+  size_t args_len = package[0] * 4;
+  uint8_t ro_count = package[2];
+  uint8_t rw_count = package[3];
+  // argument area, then indexes of read-only and read-write string
+  // arguments, then the appended strings
+  size_t strings_start = args_len + ro_count + rw_count;
+  if (args_len <= package_len) {
+    args.package_len = args_len;
+  }
+  if (strings_start < package_len) {
+    args.strings = package + strings_start;
+    args.strings_len = package_len - strings_start;
+    args.string_count = package[1];
+  }
+
+  uint32_t fmt_addr = get_le32(package + header_len);
+  const char *fmt = resolve_string(&args, fmt_addr, header_len / 4, lookup, ctx);
+  if (fmt == NULL) {
+    return snprintf(out, out_size, "<fmt 0x%08lx>", (unsigned long)fmt_addr);
+  }
+
+#define APPEND(...)                                                                                                                                                                                    \
+  do {                                                                                                                                                                                                 \
+    if (pos < out_size) {                                                                                                                                                                              \
+      int n = snprintf(out + pos, out_size - pos, __VA_ARGS__);                                                                                                                                        \
+      pos += n > 0 ? (size_t)n : 0;                                                                                                                                                                    \
+    }                                                                                                                                                                                                  \
+  } while (0)
+
+  for (const char *f = fmt; *f && pos < out_size; f++) {
+    if (*f != '%') {
+      out[pos++] = *f;
+      continue;
+    }
+    if (f[1] == '%') {
+      out[pos++] = '%';
+      f++;
+      continue;
+    }
+
+    // copy the conversion spec without its length modifier so it can be
+    // handed to snprintf with a value of known type, '*' width and
+    // precision are taken from the package and written out as digits
+    char spec[40];
+    size_t spec_len = 0;
+    bool missing = false;
+    spec[spec_len++] = '%';
+    f++;
+    while (*f && strchr("-+ #0123456789.*", *f)) {
+      if (*f != '*') {
+        if (spec_len < sizeof(spec) - 16) {
+          spec[spec_len++] = *f;
+        }
+        f++;
+        continue;
+      }
+      uint64_t star;
+      size_t star_word;
+      if (!next_arg(&args, 4, &star, &star_word)) {
+        missing = true;
+      } else if ((int32_t)star < 0 && spec[spec_len - 1] == '.') {
+        // a negative precision counts as omitted
+        spec_len--;
+      } else if (spec_len < sizeof(spec) - 16) {
+        spec_len += snprintf(spec + spec_len, sizeof(spec) - spec_len, "%ld", (long)(int32_t)star);
+      }
+      f++;
+    }
+    // the target is 32-bit, so only ll, j (intmax_t) and floating point
+    // arguments take 8 bytes, z and t are 4 like int
+    bool wide = false;
+    int longs = 0;
+    while (*f && strchr("hlzjtL", *f)) {
+      if (*f == 'l' || *f == 'L') {
+        wide = ++longs >= 2;
+      } else if (*f == 'j') {
+        wide = true;
+      }
+      f++;
+    }
+    char conv = *f;
+    if (conv == '\0') {
+      break;
+    }
+
+    size_t size = (wide || strchr("fFeEgGaA", conv)) ? 8 : 4;
+    uint64_t value;
+    size_t word;
+    if (missing || !next_arg(&args, size, &value, &word)) {
+      APPEND("<?>");
+      continue;
+    }
+
+    switch (conv) {
+    case 'd':
+    case 'i':
+      memcpy(spec + spec_len, "lld", 4);
+      APPEND(spec, size == 8 ? (long long)value : (long long)(int32_t)value);
+      break;
+    case 'u':
+    case 'x':
+    case 'X':
+    case 'o':
+      spec[spec_len++] = 'l';
+      spec[spec_len++] = 'l';
+      spec[spec_len++] = conv;
+      spec[spec_len] = '\0';
+      APPEND(spec, (unsigned long long)value);
+      break;
+    case 'c':
+      memcpy(spec + spec_len, "c", 2);
+      APPEND(spec, (int)(uint8_t)value);
+      break;
+    case 'p':
+      APPEND("0x%08lx", (unsigned long)value);
+      break;
+    case 's': {
+      const char *str = resolve_string(&args, (uint32_t)value, word, lookup, ctx);
+      if (str == NULL) {
+        APPEND("<str 0x%08lx>", (unsigned long)value);
+      } else {
+        memcpy(spec + spec_len, "s", 2);
+        APPEND(spec, str);
+      }
+      break;
+    }
+    case 'f':
+    case 'F':
+    case 'e':
+    case 'E':
+    case 'g':
+    case 'G':
+    case 'a':
+    case 'A': {
+      double d;
+      memcpy(&d, &value, sizeof(d));
+      spec[spec_len++] = conv;
+      spec[spec_len] = '\0';
+      APPEND(spec, d);
+      break;
+    }
+    default:
+      APPEND("<%%%c>", conv);
+      break;
+    }
+  }
+
+#undef APPEND
+
+  if (pos >= out_size) {
+    pos = out_size - 1;
+  }
+  out[pos] = '\0';
+  return pos;
+}
@@ -0,0 +1,134 @@
+/*
+ * SPDX-FileCopyrightText: 2022-2024 Espressif Systems (Shanghai) CO LTD
+ *
+ * SPDX-License-Identifier: CC0-1.0
+ */
+
+#ifndef ZLOG_DECODER_H
+#define ZLOG_DECODER_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// Written by the Zephyr UART backend before dictionary output starts, only
+// in the hex variant (CONFIG_LOG_BACKEND_UART_OUTPUT_DICTIONARY_HEX)
+#define ZLOG_SYNC_MAGIC "##ZLOGV1##"
+#define ZLOG_MAX_RECORD (1024)
+// Raw bytes of a record kept until its header is validated, enough for the
+// longest header in hex with some whitespace
+#define ZLOG_MAX_PENDING (64)
+
+#define ZLOG_MSG_TYPE_NORMAL (0)
+#define ZLOG_MSG_TYPE_DROPPED (1)
+
+/**
+ * @brief Decoded record header, stored in front of the cbprintf package
+ *
+ * This is what the parse stage keeps; the text is only produced by
+ * zlog_format() when the record is displayed.
+ */
+typedef struct {
+  uint64_t timestamp; /*!< Target timestamp, first so it can be skipped when comparing records */
+  uint32_t source;    /*!< Address of the log source */
+  uint8_t level;      /*!< 1 error, 2 warning, 3 info, 4 debug */
+  uint8_t domain;
+  uint16_t dropped; /*!< Messages dropped by the target, record has no package */
+} zlog_record_t;
+
+/**
+ * @brief Called for every complete record
+ *
+ * @param package cbprintf package of the record, NULL for dropped records.
+ *                Truncated to ZLOG_MAX_RECORD.
+ */
+typedef void (*zlog_record_cb_t)(const zlog_record_t *record, const uint8_t *package, size_t package_len, void *ctx);
+
+/**
+ * @brief Called with runs of bytes that are plain text, not dictionary data
+ */
+typedef void (*zlog_text_cb_t)(const uint8_t *data, size_t len, void *ctx);
+
+typedef enum {
+  ZLOG_STATE_TEXT,   /*!< Plain text, searching for the sync magic */
+  ZLOG_STATE_TYPE,   /*!< Expecting a message type byte */
+  ZLOG_STATE_HEADER, /*!< Collecting the fixed part of a record */
+  ZLOG_STATE_BODY,   /*!< Collecting package and hexdump data */
+} zlog_state_t;
+
+/**
+ * @brief Zephyr dictionary log stream decoder (log_output_dict v3)
+ *
+ * Passes text through until ZLOG_SYNC_MAGIC is seen, then splits the stream
+ * into records. A byte that cannot be part of a record header switches back
+ * to text, so a rebooting target printing its bootloader banner is shown as
+ * text again; the header bytes received so far are passed on with it.
+ * Does not depend on FreeRTOS so it can be built on the host.
+ */
+typedef struct {
+  zlog_state_t state;
+  bool hex;             /*!< Stream uses the hex variant of the backend */
+  bool timestamp_64;    /*!< Target built with CONFIG_LOG_TIMESTAMP_64BIT */
+  uint8_t sync_pos;
+  uint8_t held;         /*!< Leading bytes of the partial match received in earlier chunks */
+  bool unsynced;        /*!< Records may start without the sync magic */
+  int16_t hex_high;     /*!< Pending high nibble in hex mode, -1 if none */
+  uint8_t type;         /*!< ZLOG_MSG_TYPE_* of the current record */
+  size_t need;          /*!< Bytes of the current state still missing */
+  size_t have;          /*!< Bytes of the current record received */
+  size_t package_len;
+  size_t data_len;
+  zlog_record_t record;
+  uint8_t pending[ZLOG_MAX_PENDING]; /*!< Raw bytes of the current record up to its body */
+  size_t pending_len;
+  uint8_t buf[ZLOG_MAX_RECORD];
+  zlog_record_cb_t record_cb;
+  zlog_text_cb_t text_cb;
+  void *cb_ctx;
+} zlog_decoder_t;
+
+void zlog_decoder_init(zlog_decoder_t *dec, bool hex, bool timestamp_64, zlog_record_cb_t record_cb, zlog_text_cb_t text_cb, void *ctx);
+
+/**
+ * @brief Decode records without waiting for ZLOG_SYNC_MAGIC
+ *
+ * The binary variant of the backend never writes the magic. With this set, a
+ * record is tried at the start of the stream and after every line of text;
+ * text falls back at its first byte, which can never start a record. Has no
+ * effect on the hex variant, where text can look like hex digits.
+ */
+void zlog_decoder_set_unsynced(zlog_decoder_t *dec, bool enable);
+
+/**
+ * @brief Feed raw bytes, text runs and records are delivered to the callbacks
+ */
+void zlog_decoder_feed(zlog_decoder_t *dec, const uint8_t *data, size_t len);
+
+/**
+ * @brief True once the sync magic was seen and records are being decoded
+ */
+bool zlog_decoder_active(const zlog_decoder_t *dec);
+
+/**
+ * @brief Lookup of constant strings by target address
+ */
+typedef const char *(*zlog_string_lookup_t)(uint32_t addr, void *ctx);
+
+/**
+ * @brief Render a cbprintf package into text
+ *
+ * @param header_len Size of the package header, 4, or 8 with
+ *                   CONFIG_CBPRINTF_PACKAGE_HEADER_STORE_CREATION_FLAGS
+ * @return Length of the text written to out
+ */
+size_t zlog_format(const uint8_t *package, size_t package_len, size_t header_len, zlog_string_lookup_t lookup, void *ctx, char *out, size_t out_size);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // ZLOG_DECODER_H
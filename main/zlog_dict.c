@@ -0,0 +1,241 @@
+/*
+ * SPDX-FileCopyrightText: 2022-2024 Espressif Systems (Shanghai) CO LTD
+ *
+ * SPDX-License-Identifier: CC0-1.0
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "cJSON.h"
+#include "esp_heap_caps.h"
+#include "esp_log.h"
+#include "mbedtls/base64.h"
+
+#include "storage.h"
+#include "zlog_decoder.h"
+#include "zlog_dict.h"
+
+static const char *TAG = "zlog_dict";
+
+typedef struct {
+  uint32_t start;
+  uint32_t end;
+  uint8_t *data;
+} zlog_section_t;
+
+typedef struct {
+  uint32_t addr;
+  char *name;
+} zlog_source_t;
+
+static zlog_section_t *sections = NULL;
+static size_t section_count = 0;
+static zlog_source_t *sources = NULL;
+static size_t source_count = 0;
+static bool loaded = false;
+static bool timestamp_64 = false;
+static size_t package_header_len = 4;
+static uint32_t timestamp_freq = 0;
+
+static void *dict_alloc(size_t size) { return heap_caps_malloc(size, MALLOC_CAP_SPIRAM | MALLOC_CAP_8BIT); }
+
+static char *read_file(const char *path, size_t *len) {
+  FILE *f = fopen(path, "rb");
+  if (f == NULL) {
+    return NULL;
+  }
+  fseek(f, 0, SEEK_END);
+  long size = ftell(f);
+  fseek(f, 0, SEEK_SET);
+  char *data = size > 0 ? dict_alloc(size + 1) : NULL;
+  if (data != NULL && fread(data, 1, size, f) != (size_t)size) {
+    free(data);
+    data = NULL;
+  }
+  fclose(f);
+  if (data != NULL) {
+    data[size] = '\0';
+    *len = size;
+  }
+  return data;
+}
+
+// Kconfig values are stored as "y", numbers or strings depending on the type
+static bool kconfig_enabled(const cJSON *kconfigs, const char *name) {
+  const cJSON *item = cJSON_GetObjectItem(kconfigs, name);
+  if (cJSON_IsString(item)) {
+    return strcmp(item->valuestring, "y") == 0;
+  }
+  return cJSON_IsTrue(item) || (cJSON_IsNumber(item) && item->valuedouble != 0);
+}
+
+static uint32_t kconfig_uint(const cJSON *kconfigs, const char *name) {
+  const cJSON *item = cJSON_GetObjectItem(kconfigs, name);
+  if (cJSON_IsString(item)) {
+    return strtoul(item->valuestring, NULL, 0);
+  }
+  return cJSON_IsNumber(item) ? (uint32_t)item->valuedouble : 0;
+}
+
+static void load_sections(const cJSON *json) {
+  const cJSON *json_sections = cJSON_GetObjectItem(json, "sections");
+  size_t count = cJSON_GetArraySize(json_sections);
+  sections = dict_alloc(count * sizeof(zlog_section_t));
+  if (sections == NULL) {
+    return;
+  }
+
+  const cJSON *sect;
+  cJSON_ArrayForEach(sect, json_sections) {
+    const cJSON *start = cJSON_GetObjectItem(sect, "start");
+    const cJSON *b64 = cJSON_GetObjectItem(sect, "data_b64");
+    if (!cJSON_IsNumber(start) || !cJSON_IsString(b64)) {
+      continue;
+    }
+
+    size_t b64_len = strlen(b64->valuestring);
+    size_t size = 0;
+    mbedtls_base64_decode(NULL, 0, &size, (const unsigned char *)b64->valuestring, b64_len);
+    zlog_section_t *s = &sections[section_count];
+    // one extra NUL so a string at the very end stays terminated
+    s->data = dict_alloc(size + 1);
+    if (s->data == NULL || mbedtls_base64_decode(s->data, size, &size, (const unsigned char *)b64->valuestring, b64_len) != 0) {
+      ESP_LOGW(TAG, "Skipping section %s", sect->string);
+      free(s->data);
+      continue;
+    }
+    s->data[size] = '\0';
+    s->start = (uint32_t)start->valuedouble;
+    s->end = s->start + size;
+    section_count++;
+  }
+}
+
+static int compare_sources(const void *a, const void *b) {
+  uint32_t aa = ((const zlog_source_t *)a)->addr;
+  uint32_t ab = ((const zlog_source_t *)b)->addr;
+  return (aa > ab) - (aa < ab);
+}
+
+static void load_sources(const cJSON *json) {
+  const cJSON *instances = cJSON_GetObjectItem(cJSON_GetObjectItem(json, "log_subsys"), "log_instances");
+  size_t count = cJSON_GetArraySize(instances);
+  sources = dict_alloc(count * sizeof(zlog_source_t));
+  if (sources == NULL) {
+    return;
+  }
+
+  // keyed by source address, the value carries the name
+  const cJSON *inst;
+  cJSON_ArrayForEach(inst, instances) {
+    const cJSON *name = cJSON_IsString(inst) ? inst : cJSON_GetObjectItem(inst, "name");
+    if (!cJSON_IsString(name) || inst->string == NULL) {
+      continue;
+    }
+    char *copy = dict_alloc(strlen(name->valuestring) + 1);
+    if (copy == NULL) {
+      continue;
+    }
+    strcpy(copy, name->valuestring);
+    sources[source_count].addr = strtoul(inst->string, NULL, 0);
+    sources[source_count].name = copy;
+    source_count++;
+  }
+  qsort(sources, source_count, sizeof(zlog_source_t), compare_sources);
+}
+
+esp_err_t zlog_dict_load(void) {
+  char path[64];
+  if (!storage_find(ZLOG_DICT_FILE, path, sizeof(path))) {
+    return ESP_ERR_NOT_FOUND;
+  }
+
+  size_t len = 0;
+  char *text = read_file(path, &len);
+  if (text == NULL) {
+    ESP_LOGE(TAG, "Cannot read %s", path);
+    return ESP_FAIL;
+  }
+  cJSON *json = cJSON_ParseWithLength(text, len);
+  free(text);
+  if (json == NULL) {
+    ESP_LOGE(TAG, "%s is not valid JSON", path);
+    return ESP_ERR_INVALID_ARG;
+  }
+
+  const cJSON *target = cJSON_GetObjectItem(json, "target");
+  const cJSON *bits = cJSON_GetObjectItem(target, "bits");
+  if (cJSON_IsNumber(bits) && bits->valueint != 32) {
+    ESP_LOGE(TAG, "Only 32-bit targets are supported");
+    cJSON_Delete(json);
+    return ESP_ERR_NOT_SUPPORTED;
+  }
+
+  const cJSON *kconfigs = cJSON_GetObjectItem(json, "kconfigs");
+  timestamp_64 = kconfig_enabled(kconfigs, "CONFIG_LOG_TIMESTAMP_64BIT");
+  package_header_len = kconfig_enabled(kconfigs, "CONFIG_CBPRINTF_PACKAGE_HEADER_STORE_CREATION_FLAGS") ? 8 : 4;
+  timestamp_freq = kconfig_uint(kconfigs, "CONFIG_SYS_CLOCK_HW_CYCLES_PER_SEC");
+
+  load_sections(json);
+  load_sources(json);
+  cJSON_Delete(json);
+
+  ESP_LOGI(TAG, "Loaded %s: %u sections, %u sources", path, (unsigned)section_count, (unsigned)source_count);
+  loaded = true;
+  return ESP_OK;
+}
+
+bool zlog_dict_loaded(void) { return loaded; }
+
+bool zlog_dict_timestamp_64(void) { return timestamp_64; }
+
+const char *zlog_dict_source_name(uint32_t addr) {
+  zlog_source_t key = {.addr = addr};
+  zlog_source_t *found = bsearch(&key, sources, source_count, sizeof(zlog_source_t), compare_sources);
+  return found != NULL ? found->name : NULL;
+}
+
+const char *zlog_dict_string(uint32_t addr) {
+  for (size_t i = 0; i < section_count; i++) {
+    if (addr >= sections[i].start && addr < sections[i].end) {
+      return (const char *)sections[i].data + (addr - sections[i].start);
+    }
+  }
+  return NULL;
+}
+
+static const char *lookup_string(uint32_t addr, void *ctx) { return zlog_dict_string(addr); }
+
+size_t zlog_dict_format_message(const message_t *msg, char *out, size_t out_size) {
+  static const char *const level_names[] = {"   ", "err", "wrn", "inf", "dbg"};
+  zlog_record_t record;
+
+  if (msg->len < sizeof(record)) {
+    return snprintf(out, out_size, "<short record>");
+  }
+  memcpy(&record, msg->data, sizeof(record));
+
+  size_t pos;
+  if (timestamp_freq != 0) {
+    uint64_t us = record.timestamp * 1000000ULL / timestamp_freq;
+    pos = snprintf(out, out_size, "[%llu.%06llu] ", (unsigned long long)(us / 1000000), (unsigned long long)(us % 1000000));
+  } else {
+    pos = snprintf(out, out_size, "[%llu] ", (unsigned long long)record.timestamp);
+  }
+
+  const char *source = zlog_dict_source_name(record.source);
+  if (pos < out_size) {
+    const char *level = record.level < 5 ? level_names[record.level] : "???";
+    if (source != NULL) {
+      pos += snprintf(out + pos, out_size - pos, "<%s> %s: ", level, source);
+    } else {
+      pos += snprintf(out + pos, out_size - pos, "<%s> 0x%08lx: ", level, (unsigned long)record.source);
+    }
+  }
+  if (pos < out_size) {
+    pos += zlog_format((const uint8_t *)msg->data + sizeof(record), msg->len - sizeof(record), package_header_len, lookup_string, NULL, out + pos, out_size - pos);
+  }
+  return pos < out_size ? pos : out_size - 1;
+}
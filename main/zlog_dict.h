@@ -0,0 +1,71 @@
+/*
+ * SPDX-FileCopyrightText: 2022-2024 Espressif Systems (Shanghai) CO LTD
+ *
+ * SPDX-License-Identifier: CC0-1.0
+ */
+
+#ifndef ZLOG_DICT_H
+#define ZLOG_DICT_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#include "esp_err.h"
+#include "messaging.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// Log database generated by the Zephyr build (build/zephyr/log_dictionary.json)
+#define ZLOG_DICT_FILE "log_dictionary.json"
+// Set to 1 for targets using CONFIG_LOG_BACKEND_UART_OUTPUT_DICTIONARY_HEX,
+// the default binary variant is decoded once a dictionary is loaded
+#define ZLOG_DICT_STREAM_HEX (0)
+
+/**
+ * @brief Load the log dictionary from the SD card or the storage partition
+ *
+ * String sections are decoded into PSRAM. Records are decoded without a
+ * dictionary too, they are then shown with raw addresses.
+ *
+ * @return
+ *    - ESP_OK: Success
+ *    - ESP_ERR_NOT_FOUND: No dictionary file
+ *    - Others: Fail
+ */
+esp_err_t zlog_dict_load(void);
+
+/**
+ * @brief True once zlog_dict_load() succeeded
+ */
+bool zlog_dict_loaded(void);
+
+/**
+ * @brief True if the target stores 64-bit log timestamps
+ */
+bool zlog_dict_timestamp_64(void);
+
+/**
+ * @brief Name of a log source, NULL if unknown
+ */
+const char *zlog_dict_source_name(uint32_t addr);
+
+/**
+ * @brief Constant string at a target address, NULL if unknown
+ */
+const char *zlog_dict_string(uint32_t addr);
+
+/**
+ * @brief Render a MESSAGE_FORMAT_ZLOG message as a log line
+ *
+ * @return Length of the text written to out
+ */
+size_t zlog_dict_format_message(const message_t *msg, char *out, size_t out_size);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // ZLOG_DICT_H
@@ -0,0 +1,164 @@
+/*
+ * SPDX-FileCopyrightText: 2022-2024 Espressif Systems (Shanghai) CO LTD
+ *
+ * SPDX-License-Identifier: CC0-1.0
+ */
+
+/*
+ * Host checks of the portable pipeline stages.
+ *
+ *   cc -O2 -Imain -o log_check tools/log_check.c main/log_dedup.c main/log_stats.c main/zlog_decoder.c
+ *   ./log_check
+ *
+ * Prints every failed check and exits with status 1 if there was one.
+ */
+
+#include <stdio.h>
+#include <string.h>
+
+#include "log_dedup.h"
+#include "log_stats.h"
+#include "zlog_decoder.h"
+
+static int failures = 0;
+
+#define CHECK(cond)                                                                                                                                                                                    \
+  do {                                                                                                                                                                                                 \
+    if (!(cond)) {                                                                                                                                                                                     \
+      printf("%s:%d: %s\n", __func__, __LINE__, #cond);                                                                                                                                               \
+      failures++;                                                                                                                                                                                      \
+    }                                                                                                                                                                                                  \
+  } while (0)
+
+// Row ids are assigned the way the pipeline does: only new lines take one
+static uint32_t dedup_feed(log_dedup_t *dedup, const char *line, uint32_t *next_seq, int64_t now_us) {
+  log_dedup_entry_t evicted;
+  log_dedup_entry_t *entry = log_dedup_check(dedup, line, strlen(line), *next_seq, now_us, &evicted);
+  if (entry != NULL) {
+    return entry->seq;
+  }
+  return (*next_seq)++;
+}
+
+static void check_dedup_repeats(void) {
+  static log_dedup_t dedup;
+  uint32_t next_seq = 0;
+  log_dedup_init(&dedup);
+
+  uint32_t first = dedup_feed(&dedup, "heartbeat", &next_seq, 1);
+  CHECK(dedup_feed(&dedup, "heartbeat", &next_seq, 2) == first);
+  CHECK(dedup_feed(&dedup, "other", &next_seq, 3) != first);
+  CHECK(dedup_feed(&dedup, "heartbeat", &next_seq, 4) == first);
+  CHECK(next_seq == 2);
+}
+
+// A line recurring between unique lines must not stay folded into a row that
+// has left the view
+static void check_dedup_row_limit(void) {
+  static log_dedup_t dedup;
+  uint32_t next_seq = 0;
+  int64_t now = 0;
+  log_dedup_init(&dedup);
+
+  uint32_t row = dedup_feed(&dedup, "heartbeat", &next_seq, ++now);
+  for (int i = 0; i < 3 * MAX_LOG_ROWS; i++) {
+    char line[32];
+    snprintf(line, sizeof(line), "unique %d", i);
+    dedup_feed(&dedup, line, &next_seq, ++now);
+
+    uint32_t seq = dedup_feed(&dedup, "heartbeat", &next_seq, ++now);
+    // the newest MAX_LOG_ROWS rows are shown
+    CHECK(next_seq - seq <= MAX_LOG_ROWS);
+    if (seq != row) {
+      CHECK(seq == next_seq - 1);
+      row = seq;
+    }
+  }
+}
+
+static bool parses_as(const char *line, log_stats_level_t level, const char *tag) {
+  char parsed[LOG_STATS_TAG_LEN];
+  return log_stats_parse(line, strlen(line), parsed, sizeof(parsed)) == level && strcmp(parsed, tag) == 0;
+}
+
+static void check_stats_parse(void) {
+  CHECK(parses_as("I (4846) HEX: 00 01", LOG_STATS_LEVEL_INFO, "HEX"));
+  CHECK(parses_as("W (413) MSPI DQS: tuning", LOG_STATS_LEVEL_WARN, "MSPI DQS"));
+  // ESP-IDF without timestamps
+  CHECK(parses_as("I esp_psram: Found 32MB PSRAM device", LOG_STATS_LEVEL_INFO, "esp_psram"));
+  CHECK(parses_as("E wifi: timeout", LOG_STATS_LEVEL_ERROR, "wifi"));
+  CHECK(parses_as("I am not a log line", LOG_STATS_LEVEL_NONE, "-"));
+  CHECK(parses_as("E 12:30 is late", LOG_STATS_LEVEL_NONE, "-"));
+  CHECK(parses_as("[00:00:01.000,000] <inf> net: up", LOG_STATS_LEVEL_INFO, "net"));
+  CHECK(parses_as("D: context_boot_go", LOG_STATS_LEVEL_DEBUG, "context_boot_go"));
+}
+
+// Records show up as <level> in the text stream
+static char zlog_out[256];
+static size_t zlog_out_len;
+
+static void zlog_text(const uint8_t *data, size_t len, void *ctx) {
+  memcpy(zlog_out + zlog_out_len, data, len);
+  zlog_out_len += len;
+  zlog_out[zlog_out_len] = '\0';
+}
+
+static void zlog_record(const zlog_record_t *record, const uint8_t *package, size_t package_len, void *ctx) {
+  zlog_out_len += snprintf(zlog_out + zlog_out_len, sizeof(zlog_out) - zlog_out_len, "<%u>", record->level);
+}
+
+// Info record, 32-bit timestamp, an 8 byte package and no hexdump data
+static const uint8_t zlog_info[] = {0x00, 0x30, 0x08, 0x00, 0x00, 0x00, 0, 0, 0, 0, 0, 0, 0, 0, 1, 2, 3, 4, 5, 6, 7, 8};
+
+static void zlog_run(bool hex, bool unsynced, const uint8_t *data, size_t len, bool bytewise) {
+  static zlog_decoder_t dec;
+  zlog_decoder_init(&dec, hex, false, zlog_record, zlog_text, NULL);
+  zlog_decoder_set_unsynced(&dec, unsynced);
+  zlog_out_len = 0;
+  zlog_out[0] = '\0';
+  for (size_t i = 0; i < len; i += bytewise ? 1 : len) {
+    zlog_decoder_feed(&dec, data + i, bytewise ? 1 : len);
+  }
+}
+
+static void check_zlog_binary_unsynced(void) {
+  // the binary backend writes no sync magic
+  uint8_t stream[128];
+  size_t len = 0;
+  memcpy(stream + len, zlog_info, sizeof(zlog_info));
+  len += sizeof(zlog_info);
+  memcpy(stream + len, "*** Booting MCUboot\n\n", 21);
+  len += 21;
+  memcpy(stream + len, zlog_info, sizeof(zlog_info));
+  len += sizeof(zlog_info);
+
+  for (int bytewise = 0; bytewise <= 1; bytewise++) {
+    zlog_run(false, true, stream, len, bytewise);
+    CHECK(strcmp(zlog_out, "<3>*** Booting MCUboot\n\n<3>") == 0);
+  }
+}
+
+static void check_zlog_hex_fallback(void) {
+  // MCUboot lines start with hex digits, they must survive the switch back
+  static const char stream[] = "boot\n##ZLOGV1##00300800000000000000000000000102030405060708D: context_boot_go\nE: bad\n";
+
+  for (int bytewise = 0; bytewise <= 1; bytewise++) {
+    zlog_run(true, true, (const uint8_t *)stream, strlen(stream), bytewise);
+    CHECK(strcmp(zlog_out, "boot\n<3>D: context_boot_go\nE: bad\n") == 0);
+  }
+}
+
+int main(void) {
+  check_dedup_repeats();
+  check_dedup_row_limit();
+  check_stats_parse();
+  check_zlog_binary_unsynced();
+  check_zlog_hex_fallback();
+
+  if (failures != 0) {
+    printf("%d checks failed\n", failures);
+    return 1;
+  }
+  printf("all checks passed\n");
+  return 0;
+}
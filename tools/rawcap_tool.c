@@ -0,0 +1,88 @@
+/*
+ * SPDX-FileCopyrightText: 2022-2024 Espressif Systems (Shanghai) CO LTD
+ *
+ * SPDX-License-Identifier: CC0-1.0
+ */
+
+/*
+ * Host tool for raw captures recorded by the viewer (main/rawcap.h).
+ *
+ *   cc -O2 -Imain -o rawcap_tool tools/rawcap_tool.c main/rawcap.c main/vcp_rx.c main/log_framer.c
+ *   ./rawcap_tool info capture_000.ulr    chunk count, sizes, timing, line errors
+ *   ./rawcap_tool raw capture_000.ulr     concatenated bytes to stdout, as delivered
+ *   ./rawcap_tool lines capture_000.ulr   framed lines to stdout
+ *
+ * "lines" feeds the chunks through the same status stripping and framer as
+ * the device, with the original chunk boundaries, so framing bugs reproduce
+ * on the host.
+ */
+
+#include <stdio.h>
+#include <string.h>
+
+#include "log_framer.h"
+#include "rawcap.h"
+#include "vcp_rx.h"
+
+#define MAX_CHUNK (65536)
+
+static void print_line(message_t *msg, void *ctx) { printf("%s%s\n", msg->kind == MESSAGE_KIND_REPLACE ? "\\r " : "", msg->data); }
+
+static void frame(const uint8_t *data, size_t len, void *ctx) {
+  if (ctx != NULL) {
+    log_framer_feed((log_framer_t *)ctx, data, len);
+  }
+}
+
+int main(int argc, char **argv) {
+  static uint8_t chunk[MAX_CHUNK];
+  rawcap_reader_t reader;
+
+  if (argc != 3) {
+    fprintf(stderr, "usage: %s info|raw|lines <capture>\n", argv[0]);
+    return 1;
+  }
+  if (!rawcap_reader_open(&reader, argv[2])) {
+    fprintf(stderr, "%s is not a capture file\n", argv[2]);
+    return 1;
+  }
+
+  const char *mode = argv[1];
+  static log_framer_t framer;
+  static vcp_rx_t rx;
+  log_framer_init(&framer, print_line, NULL);
+  // status bytes are decoded in every mode so "info" can count line errors
+  vcp_rx_init(&rx, reader.header.driver, reader.header.max_packet, frame, strcmp(mode, "lines") == 0 ? &framer : NULL);
+
+  uint64_t total_us = 0;
+  uint64_t bytes = 0;
+  uint32_t chunks = 0;
+  uint32_t max_chunk = 0;
+  uint32_t delta_us;
+  int len;
+
+  while ((len = rawcap_reader_next(&reader, chunk, sizeof(chunk), &delta_us)) >= 0) {
+    total_us += delta_us;
+    bytes += len;
+    chunks++;
+    if ((uint32_t)len > max_chunk) {
+      max_chunk = len;
+    }
+
+    if (strcmp(mode, "raw") == 0) {
+      fwrite(chunk, 1, len, stdout);
+    }
+    vcp_rx_feed(&rx, chunk, len);
+  }
+  rawcap_reader_close(&reader);
+
+  if (strcmp(mode, "info") == 0) {
+    printf("driver %u, max packet %u, started at %lld us\n", reader.header.driver, reader.header.max_packet, (long long)reader.header.start_us);
+    printf("%u chunks, %llu bytes, max chunk %u bytes, %.3f s\n", chunks, (unsigned long long)bytes, max_chunk, total_us / 1e6);
+    if (total_us > 0) {
+      printf("average %.0f B/s\n", bytes * 1e6 / total_us);
+    }
+    printf("line errors: %u overrun, %u parity, %u framing, %u break\n", rx.errors.overrun, rx.errors.parity, rx.errors.framing, rx.errors.breaks);
+  }
+  return 0;
+}
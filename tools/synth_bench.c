@@ -0,0 +1,132 @@
+/*
+ * SPDX-FileCopyrightText: 2022-2024 Espressif Systems (Shanghai) CO LTD
+ *
+ * SPDX-License-Identifier: CC0-1.0
+ */
+
+/*
+ * Host build of the synthetic log source, the FTDI status stripping and the
+ * line framer.
+ *
+ * Measures how many bytes and lines per second the framing stage sustains on
+ * the host, using the same generator the device uses for stress testing.
+ *
+ *   cc -O2 -Imain -o synth_bench tools/synth_bench.c main/synth_gen.c main/vcp_rx.c main/log_framer.c
+ *   ./synth_bench [-l line_len] [-a ansi_percent] [-f ftdi_max_packet] [-r file] [-s seconds]
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+
+#include "log_framer.h"
+#include "synth_gen.h"
+#include "vcp_rx.h"
+
+#define CHUNK_SIZE (256)
+
+static double now_sec(void) {
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+static log_framer_t framer;
+static size_t lines = 0;
+
+static void count_line(message_t *msg, void *ctx) {
+  size_t *chars = (size_t *)ctx;
+  *chars += msg->len;
+}
+
+static void frame(const uint8_t *data, size_t len, void *ctx) { lines += log_framer_feed(&framer, data, len); }
+
+static uint8_t *read_file(const char *path, size_t *len) {
+  FILE *f = fopen(path, "rb");
+  if (f == NULL) {
+    return NULL;
+  }
+  fseek(f, 0, SEEK_END);
+  long size = ftell(f);
+  fseek(f, 0, SEEK_SET);
+  uint8_t *data = size > 0 ? malloc(size) : NULL;
+  if (data != NULL && fread(data, 1, size, f) != (size_t)size) {
+    free(data);
+    data = NULL;
+  }
+  fclose(f);
+  *len = size;
+  return data;
+}
+
+int main(int argc, char **argv) {
+  synth_config_t cfg = {
+      .mode = SYNTH_MODE_PATTERN,
+      .line_len = 80,
+      .lines_per_sec = 100,
+      .ansi_percent = 50,
+      .ftdi_max_packet = SYNTH_FTDI_MAX_PACKET,
+  };
+  double seconds = 2.0;
+  uint8_t *replay = NULL;
+  int opt;
+
+  while ((opt = getopt(argc, argv, "l:a:f:r:s:")) != -1) {
+    switch (opt) {
+    case 'l':
+      cfg.line_len = atoi(optarg);
+      break;
+    case 'a':
+      cfg.ansi_percent = atoi(optarg);
+      break;
+    case 'f':
+      cfg.ftdi_max_packet = atoi(optarg);
+      break;
+    case 'r':
+      replay = read_file(optarg, &cfg.replay_len);
+      if (replay == NULL) {
+        fprintf(stderr, "cannot read %s\n", optarg);
+        return 1;
+      }
+      cfg.mode = SYNTH_MODE_REPLAY;
+      cfg.replay_data = replay;
+      break;
+    case 's':
+      seconds = atof(optarg);
+      break;
+    default:
+      fprintf(stderr, "usage: %s [-l line_len] [-a ansi_percent] [-f ftdi_max_packet] [-r file] [-s seconds]\n", argv[0]);
+      return 1;
+    }
+  }
+
+  static synth_gen_t gen;
+  static vcp_rx_t rx;
+  static uint8_t chunk[CHUNK_SIZE];
+  size_t chars = 0;
+  uint64_t bytes = 0;
+
+  synth_gen_init(&gen, &cfg);
+  vcp_rx_init(&rx, cfg.ftdi_max_packet != 0 ? VCP_DRIVER_FT23X : VCP_DRIVER_UNKNOWN, cfg.ftdi_max_packet, frame, NULL);
+  log_framer_init(&framer, count_line, &chars);
+
+  double start = now_sec();
+  double elapsed = 0;
+  do {
+    // check the clock once per 1024 chunks to keep it out of the profile
+    for (int i = 0; i < 1024; i++) {
+      synth_gen_fill(&gen, chunk, CHUNK_SIZE);
+      vcp_rx_feed(&rx, chunk, CHUNK_SIZE);
+    }
+    bytes += 1024 * CHUNK_SIZE;
+    elapsed = now_sec() - start;
+  } while (elapsed < seconds);
+
+  printf("mode %s, %.2f s\n", cfg.mode == SYNTH_MODE_REPLAY ? "replay" : "pattern", elapsed);
+  printf("max sustained: %.0f B/s, %.0f lines/s (%.0f text chars/s)\n", bytes / elapsed, lines / elapsed, chars / elapsed);
+
+  free(replay);
+  return 0;
+}